@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include "frame_parser.h"
+#include "spsc_queue.h"
+
+namespace esphome {
+namespace ld6001 {
+
+struct FrameEvent {
+  enum Type : uint8_t {
+    STATUS,
+    RADAR,
+  };
+
+  Type type;
+  StatusResponse status;
+  RadarResponse radar;
+};
+
+// Frame handler that records every callback as an event instead of handling it. The parser can then run in its own
+// task, while the events are replayed on the main loop with dispatch().
+template<size_t N> class FrameEventQueue : public FrameHandler {
+ public:
+  void on_status_response(const StatusResponse &response) override {
+    this->event_.type = FrameEvent::STATUS;
+    this->event_.status = response;
+    this->queue_.push(this->event_);
+  }
+
+  void on_radar_response(const RadarResponse &response) override {
+    this->event_.type = FrameEvent::RADAR;
+    this->event_.radar = response;
+    this->queue_.push(this->event_);
+  }
+
+  // Consumer side: replays all queued events on the given handler, returns the number of events handled
+  size_t dispatch(FrameHandler &handler) {
+    size_t count = 0;
+
+    while (this->queue_.pop(this->received_)) {
+      switch (this->received_.type) {
+        case FrameEvent::STATUS:
+          handler.on_status_response(this->received_.status);
+          break;
+        case FrameEvent::RADAR:
+          handler.on_radar_response(this->received_.radar);
+          break;
+      }
+
+      count++;
+    }
+
+    return count;
+  }
+
+  // Events that were lost because the consumer did not keep up
+  uint32_t get_dropped() const { return this->queue_.get_dropped(); }
+
+ protected:
+  FrameEvent event_{};     // Producer side scratch event
+  FrameEvent received_{};  // Consumer side scratch event
+  SpscQueue<FrameEvent, N> queue_;
+};
+
+}  // namespace ld6001
+}  // namespace esphome
@@ -8,6 +8,8 @@
 #include <cstddef>
 #include <cstring>
 #include "esphome/core/log.h"
+#include "frame_buffer.h"
+#include "parser_stats.h"
 
 namespace esphome {
 namespace ld6001 {
@@ -21,7 +23,7 @@ struct StatusResponse {
   uint8_t hardware_version_major;
   bool initialized;
 
-  static StatusResponse create(const std::vector<uint8_t> &buffer) {
+  static StatusResponse create(const uint8_t *buffer, size_t length) {
     return StatusResponse{.software_version_minor = buffer[4],
                           .software_version_major = buffer[5],
                           .hardware_version_minor = buffer[6],
@@ -30,6 +32,23 @@ struct StatusResponse {
   }
 };
 
+// Read-only view on a contiguous range of elements, used to hand fixed size buffers around without copying them
+template<typename T> class Span {
+ public:
+  Span() = default;
+  Span(const T *data, size_t size) : data_(data), size_(size) {}
+
+  const T *begin() const { return this->data_; }
+  const T *end() const { return this->data_ + this->size_; }
+  const T &operator[](size_t index) const { return this->data_[index]; }
+  size_t size() const { return this->size_; }
+  bool empty() const { return this->size_ == 0; }
+
+ protected:
+  const T *data_ = nullptr;
+  size_t size_ = 0;
+};
+
 struct Target {
   uint8_t id;
   uint8_t pitch_angle;
@@ -44,10 +63,12 @@ struct RadarResponse {
   uint8_t fault_status;
   Target people[MAX_TARGETS];
 
-  static RadarResponse create(const std::vector<uint8_t> &buffer) {
+  static RadarResponse create(const uint8_t *buffer, size_t length) {
     RadarResponse response;
     response.fault_status = buffer[4];
-    response.targets = buffer[5];
+    // Never read past the frame, even if the reported count disagrees with the body length
+    size_t targets_in_frame = length >= 14 ? (length - 14) / 8 : 0;
+    response.targets = std::min<size_t>({buffer[5], targets_in_frame, MAX_TARGETS});
 
     for (int target = 0; target < MAX_TARGETS; target++) {
       size_t offset = 12 + target * 8;
@@ -88,17 +109,36 @@ class FrameHandler {
 
 class FrameParser {
  public:
-  FrameParser(FrameHandler &handler) : handler_(&handler) {
-    current_.reserve(256);
-    buffer_.reserve(256);
-  };
+  FrameParser(FrameHandler &handler) : handler_(&handler) {}
+
+  // Route the callbacks of all following frames to another handler
+  void set_frame_handler(FrameHandler &handler) { handler_ = &handler; }
 
   void push_data(unsigned char byte) {
-    buffer_.push_back(byte);  // Add byte to the buffer
-    try_parse_frame_();       // Try to parse frame after every new byte
+    this->push_buffer_(&byte, 1);  // Add byte to the buffer, counted as dropped when full
+    try_parse_frame_();            // Try to parse frame after every new byte
   };
 
-  static uint8_t get_iterator_checksum(std::vector<uint8_t>::iterator begin, std::vector<uint8_t>::iterator end) {
+  // Push a chunk of bytes, e.g. everything currently available on the UART. Frames are only searched for once per
+  // chunk instead of once per byte.
+  void push_data(const uint8_t *data, size_t len) {
+    while (len > 0) {
+      size_t count = std::min(len, buffer_.available());
+
+      if (count == 0) {
+        this->push_buffer_(data, len);  // Nothing fits anymore, only count the bytes as dropped
+        break;
+      }
+
+      this->push_buffer_(data, count);
+      try_parse_frame_();
+
+      data += count;
+      len -= count;
+    }
+  };
+
+  template<typename Iterator> static uint8_t get_iterator_checksum(Iterator begin, Iterator end) {
     uint8_t sum = 0;
   
     for (auto it = begin; it != end; it++) {
@@ -108,22 +148,41 @@ class FrameParser {
     return sum;
   };
 
+  // Number of bytes that were thrown away because the buffer was full
+  uint32_t get_bytes_dropped() const { return buffer_.get_dropped(); }
+
+  const ParserStats &get_stats() const { return stats_; }
+
  protected:
-  void drain_until_frame_start_() {
-    while (!buffer_.empty() && buffer_[0] != FRAME_START) {
-      buffer_.erase(buffer_.begin());
+  void push_buffer_(const uint8_t *data, size_t len) {
+    size_t dropped = len - buffer_.push(data, len);
+    if (dropped > 0) {
+      stats_.buffer_overflows++;
+      stats_.bytes_discarded += dropped;
     }
+  }
+
+  void discard_(size_t count) {
+    buffer_.consume(count);
+    stats_.bytes_discarded += count;
+  }
+
+  void drain_until_frame_start_() {
+    auto *start = static_cast<const uint8_t *>(std::memchr(buffer_.data(), FRAME_START, buffer_.size()));
+    this->discard_(start == nullptr ? buffer_.size() : start - buffer_.data());
   };
   
-  void process_frame_(const std::vector<uint8_t> &frame) {
+  void process_frame_(const uint8_t *frame, size_t length) {
     uint8_t msg_type = frame[1];
   
     switch (msg_type) {
       case 0x11:
-        this->handler_->on_status_response(StatusResponse::create(frame));
+        stats_.count_frame(FrameType::STATUS);
+        this->handler_->on_status_response(StatusResponse::create(frame, length));
         break;
       case 0x62:
-        this->handler_->on_radar_response(RadarResponse::create(frame));
+        stats_.count_frame(FrameType::RADAR);
+        this->handler_->on_radar_response(RadarResponse::create(frame, length));
         break;
       default:
         // ESP_LOGW("ld6001", "Unknown message type: 0x%02X", msg_type);
@@ -142,38 +201,44 @@ class FrameParser {
   
       if (buffer_.size() < total_len)
         break;
-  
-      if (buffer_[total_len - 1] != FRAME_END) {
+
+      const uint8_t *frame = buffer_.data();
+
+      if (frame[total_len - 1] != FRAME_END) {
+        this->discard_(1);
         drain_until_frame_start_();
         continue;
       }
   
-      auto checksum = buffer_[total_len - 2];
-      auto expected_checksum = get_iterator_checksum(buffer_.begin(), buffer_.begin() + total_len - 2);
+      auto checksum = frame[total_len - 2];
+      auto expected_checksum = get_iterator_checksum(frame, frame + total_len - 2);
   
       if (checksum != expected_checksum) {
         ESP_LOGW("ld6001", "Checksum mismatch: expected %02X, got %02X", expected_checksum, checksum);
-        ESP_LOGW("ld6001", "%s", format_hex_pretty(buffer_).c_str());
+        ESP_LOGW("ld6001", "%s", format_hex_pretty(frame, total_len).c_str());
   
-        buffer_.erase(buffer_.begin());
+        stats_.checksum_failures++;
+        this->discard_(1);
+        drain_until_frame_start_();
         continue;
       }
   
-      current_.assign(buffer_.begin(), buffer_.begin() + total_len);
-      buffer_.erase(buffer_.begin(), buffer_.begin() + total_len);
-  
-      this->process_frame_(current_);
+      this->process_frame_(frame, total_len);
+      buffer_.consume(total_len);
+      drain_until_frame_start_();
     }
   };
 
  private:
-  std::vector<uint8_t> buffer_;
-  std::vector<uint8_t> current_;
-  FrameHandler *handler_;
-
   static constexpr uint8_t FRAME_START = 0x4D;
   static constexpr uint8_t FRAME_END = 0x4A;
   static constexpr size_t HEADER_SIZE = 6;
+  static constexpr size_t MAX_FRAME_SIZE = HEADER_SIZE + 255;
+
+  // Room for two maximum sized frames, so a partial frame never forces an expensive compaction
+  FrameBuffer<2 * MAX_FRAME_SIZE> buffer_;
+  FrameHandler *handler_;
+  ParserStats stats_;
 };
 
 }  // namespace ld6001
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace esphome {
+namespace ld6001 {
+
+// Occupancy heatmap, exported on demand as a compact binary blob.
+//
+// All values are little endian. The blob starts with a fixed header:
+//
+//   bytes   magic "LDH"
+//   uint8   version
+//   int16   x, y of the lower left corner of the grid in cm
+//   uint16  cell size in cm
+//   uint16  columns, rows
+//
+// followed by columns * rows uint16 bins, row by row starting at the lowest y.
+static const uint8_t HEATMAP_MAGIC[] = {'L', 'D', 'H'};
+static const uint8_t HEATMAP_VERSION = 1;
+static const size_t HEATMAP_HEADER_SIZE = sizeof(HEATMAP_MAGIC) + 1 + 2 + 2 + 2 + 2 + 2;
+static const size_t HEATMAP_MAX_CELLS = 4096;  // 8kB of bins
+
+// 2D histogram of target positions over a grid of floor cells.
+//
+// Every target of every frame adds one to the bin of its cell, saturating at UINT16_MAX. Adding is O(1) per target;
+// decay() scales all bins at once and is meant to run on a timer, so old usage fades out. Bins are allocated by
+// configure(), add() does not allocate.
+class Heatmap {
+ public:
+  // Spreads the grid over x1..x2, y1..y2 in cm. Fails if that takes more than HEATMAP_MAX_CELLS cells.
+  bool configure(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t cell_size) {
+    if (cell_size == 0 || x2 <= x1 || y2 <= y1) {
+      return false;
+    }
+
+    size_t columns = (int32_t(x2) - x1 + cell_size - 1) / cell_size;
+    size_t rows = (int32_t(y2) - y1 + cell_size - 1) / cell_size;
+    if (columns * rows > HEATMAP_MAX_CELLS) {
+      return false;
+    }
+
+    this->x_ = x1;
+    this->y_ = y1;
+    this->cell_size_ = cell_size;
+    this->columns_ = columns;
+    this->rows_ = rows;
+    this->bins_.assign(columns * rows, 0);
+    return true;
+  }
+
+  bool is_configured() const { return !this->bins_.empty(); }
+
+  // Counts a target at x, y in cm, targets outside the grid are ignored
+  void add(int16_t x, int16_t y) {
+    int32_t column = int32_t(x) - this->x_;
+    int32_t row = int32_t(y) - this->y_;
+    if (column < 0 || row < 0) {
+      return;
+    }
+
+    column /= this->cell_size_;
+    row /= this->cell_size_;
+    if (column >= this->columns_ || row >= this->rows_) {
+      return;
+    }
+
+    uint16_t &bin = this->bins_[row * this->columns_ + column];
+    bin += bin != UINT16_MAX;
+  }
+
+  // Scales every bin by factor in [0, 1], rounding down so bins that are no longer visited reach zero
+  void decay(float factor) {
+    uint32_t scale = std::min(std::max(factor, 0.0f), 1.0f) * 65536;
+    for (auto &bin : this->bins_) {
+      bin = (bin * scale) >> 16;
+    }
+  }
+
+  void clear() { std::fill(this->bins_.begin(), this->bins_.end(), 0); }
+
+  uint16_t get(size_t column, size_t row) const { return this->bins_[row * this->columns_ + column]; }
+  uint16_t get_columns() const { return this->columns_; }
+  uint16_t get_rows() const { return this->rows_; }
+  uint16_t get_cell_size() const { return this->cell_size_; }
+
+  std::vector<uint8_t> encode() const {
+    std::vector<uint8_t> data;
+    data.reserve(HEATMAP_HEADER_SIZE + this->bins_.size() * 2);
+
+    data.insert(data.end(), HEATMAP_MAGIC, HEATMAP_MAGIC + sizeof(HEATMAP_MAGIC));
+    data.push_back(HEATMAP_VERSION);
+    put(data, this->x_);
+    put(data, this->y_);
+    put(data, this->cell_size_);
+    put(data, this->columns_);
+    put(data, this->rows_);
+    for (auto bin : this->bins_) {
+      put(data, bin);
+    }
+    return data;
+  }
+
+ protected:
+  static void put(std::vector<uint8_t> &data, uint16_t value) {
+    data.push_back(value & 0xFF);
+    data.push_back(value >> 8);
+  }
+
+  int16_t x_ = 0;
+  int16_t y_ = 0;
+  uint16_t cell_size_ = 1;
+  uint16_t columns_ = 0;
+  uint16_t rows_ = 0;
+  std::vector<uint16_t> bins_;
+};
+
+}  // namespace ld6001
+}  // namespace esphome
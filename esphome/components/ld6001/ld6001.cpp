@@ -7,6 +7,7 @@
 #ifdef USE_SENSOR
 #include "esphome/components/sensor/sensor.h"
 #endif
+#include "esphome/core/application.h"
 #include "esphome/core/component.h"
 
 namespace esphome {
@@ -32,27 +33,123 @@ LD6001Component::LD6001Component() : PollingComponent(500), frame_iter_(FramePar
 
 void LD6001Component::setup() {
   ESP_LOGCONFIG(TAG, "Setting up HLK-LD6001...");
+
+#ifdef USE_SENSOR
+  this->last_diagnostics_millis_ = millis();
+  this->set_interval("diagnostics", DIAGNOSTICS_INTERVAL, [this]() { this->publish_diagnostics_(); });
+#endif
+
+#ifdef USE_LD6001_HEATMAP
+  if (this->heatmap_decay_interval_ > 0) {
+    this->set_interval("heatmap_decay", this->heatmap_decay_interval_,
+                       [this]() { this->heatmap_.decay(this->heatmap_decay_factor_); });
+  }
+#endif
+
+#ifdef USE_LD6001_PARSER_TASK
+  if (this->parser_task_) {
+    // From now on frames are parsed on the other core, loop() only picks up the results
+    this->frame_iter_.set_frame_handler(this->frame_events_);
+
+    if (xTaskCreatePinnedToCore(parser_task_loop_, "ld6001_parser", PARSER_TASK_STACK_SIZE, this, 5,
+                                &this->parser_task_handle_, 0) != pdPASS) {
+      ESP_LOGE(TAG, "Could not start parser task, parsing in loop()");
+      this->frame_iter_.set_frame_handler(*this);
+      this->parser_task_ = false;
+    }
+  }
+#endif
+
+#ifdef USE_LD6001_WARM_START
+  this->restore_warm_state_();
+#endif
+
   this->send_version_request_();
 }
 
+#ifdef USE_LD6001_WARM_START
+void LD6001Component::restore_warm_state_() {
+  Fingerprint fingerprint;
+  for (size_t i = 0; i < MAX_ZONES; i++) {
+    const auto &zone = this->zone_config_[i];
+    if (zone.is_polygon()) {
+      fingerprint.add(i).add(zone.get_vertex_count()).add(zone.x1).add(zone.y1).add(zone.x2).add(zone.y2);
+    }
+  }
+
+  uint32_t hash = fnv1_hash(App.get_friendly_name() + "_ld6001_warm_start");
+  this->warm_pref_ = global_preferences->make_preference<WarmState<MAX_ZONES>>(hash, true);
+
+  WarmState<MAX_ZONES> saved;
+  if (!this->warm_pref_.load(&saved)) {
+    saved = {};
+  }
+  if (!this->warm_start_.restore(saved, fingerprint.get())) {
+    ESP_LOGI(TAG, "Cold start, no state saved for this configuration");
+    return;
+  }
+
+  const auto &state = this->warm_start_.state;
+  ESP_LOGI(TAG, "Warm start with %u targets", state.target_count);
+
+  // Published right away, the first radar frame replaces it
+#ifdef USE_SENSOR
+  maybe_publish(this->target_count_sensor_, state.target_count);
+  for (size_t i = 0; i < MAX_ZONES; i++) {
+    maybe_publish(this->zone_target_count_sensors_[i], state.zone_counts[i]);
+  }
+#endif
+  this->warm_hold_ = true;
+}
+
+void LD6001Component::save_warm_state_(bool force) {
+  auto &state = this->warm_start_.state;
+  state.target_count = this->target_info_.targets;
+  for (size_t i = 0; i < MAX_ZONES; i++) {
+    state.zone_counts[i] = this->zone_config_[i].target_count;
+  }
+
+  uint32_t now = millis();
+  if (this->warm_start_.should_save(now, force)) {
+    ESP_LOGV(TAG, "Saving warm state");
+    this->warm_pref_.save(&state);
+    this->warm_start_.mark_saved(now);
+  }
+}
+#endif
+
+void LD6001Component::on_shutdown() {
+#ifdef USE_LD6001_WARM_START
+  // Before an OTA update or reboot, so the next boot starts from the latest state
+  this->save_warm_state_(true);
+#endif
+}
+
 void LD6001Component::dump_config() {
   ESP_LOGCONFIG(TAG, "HLK-LD6001 Human motion tracking radar module:");
+  for (size_t i = 0; i < MAX_ZONES; i++) {
+    const auto &zone = this->zone_config_[i];
+    if (zone.is_polygon()) {
+      ESP_LOGCONFIG(TAG, "  Zone %u : polygon of %u vertices within (%d, %d) (%d, %d)", i + 1, zone.get_vertex_count(),
+                    zone.x1, zone.y1, zone.x2, zone.y2);
+    }
+  }
 #ifdef USE_SENSOR
   LOG_SENSOR("  ", "TargetCountSensor", this->target_count_sensor_);
-  for (sensor::Sensor *s : this->move_x_sensors_) {
-    LOG_SENSOR("  ", "NthTargetXSensor", s);
+  for (auto &s : this->move_x_sensors_) {
+    LOG_SENSOR("  ", "NthTargetXSensor", s.sensor);
   }
-  for (sensor::Sensor *s : this->move_y_sensors_) {
-    LOG_SENSOR("  ", "NthTargetYSensor", s);
+  for (auto &s : this->move_y_sensors_) {
+    LOG_SENSOR("  ", "NthTargetYSensor", s.sensor);
   }
-  for (sensor::Sensor *s : this->move_pitch_angle_sensors_) {
-    LOG_SENSOR("  ", "NthTargetPitchAngleSensor", s);
+  for (auto &s : this->move_pitch_angle_sensors_) {
+    LOG_SENSOR("  ", "NthTargetPitchAngleSensor", s.sensor);
   }
-  for (sensor::Sensor *s : this->move_horizontal_angle_sensors_) {
-    LOG_SENSOR("  ", "NthTargetHorizontalAngleSensor", s);
+  for (auto &s : this->move_horizontal_angle_sensors_) {
+    LOG_SENSOR("  ", "NthTargetHorizontalAngleSensor", s.sensor);
   }
-  for (sensor::Sensor *s : this->move_distance_sensors_) {
-    LOG_SENSOR("  ", "NthTargetDistanceSensor", s);
+  for (auto &s : this->move_distance_sensors_) {
+    LOG_SENSOR("  ", "NthTargetDistanceSensor", s.sensor);
   }
   for (sensor::Sensor *s : this->zone_target_count_sensors_) {
     LOG_SENSOR("  ", "NthZoneTargetCountSensor", s);
@@ -60,21 +157,80 @@ void LD6001Component::dump_config() {
 #endif
 
   ESP_LOGCONFIG(TAG, "  Throttle : %ums", this->throttle_);
+  if (this->event_driven_) {
+    ESP_LOGCONFIG(TAG, "  Publishing : on frames, coalesced within %ums", this->coalesce_window_);
+  }
+  ESP_LOGCONFIG(TAG, "  Parser task : %s", YESNO(this->parser_task_));
+#ifdef USE_LD6001_HEATMAP
+  ESP_LOGCONFIG(TAG, "  Heatmap : %ux%u cells of %u cm", this->heatmap_.get_columns(), this->heatmap_.get_rows(),
+                this->heatmap_.get_cell_size());
+#endif
+
+  const auto &stats = this->get_parser_stats();
+  ESP_LOGCONFIG(TAG, "  Frames : %u radar, %u status", stats.get_frames(FrameType::RADAR),
+                stats.get_frames(FrameType::STATUS));
+  ESP_LOGCONFIG(TAG, "  Link errors : %u bytes discarded, %u checksum failures, %u buffer overflows",
+                uint32_t(stats.bytes_discarded), uint32_t(stats.checksum_failures), uint32_t(stats.buffer_overflows));
+#ifdef USE_LD6001_CAPTURE
+  ESP_LOGCONFIG(TAG, "  UART capture : %u bytes recorded", this->capture_recorder_.get_bytes_recorded());
+#endif
   ESP_LOGCONFIG(TAG, "  MAC Address : %s", const_cast<char *>(this->mac_.c_str()));
   ESP_LOGCONFIG(TAG, "  Firmware version : %s", const_cast<char *>(this->version_.c_str()));
 }
 
 void LD6001Component::loop() {
-  auto start = millis();
+#ifdef USE_LD6001_PARSER_TASK
+  if (this->parser_task_) {
+    this->frame_events_.dispatch(*this);
+    return;
+  }
+#endif
 
-  while (this->available()) {
-    uint8_t byte;
-    if (this->read_byte(&byte)) {
-      this->frame_iter_.push_data(byte);
+  this->read_uart_();
+
+#ifdef USE_LD6001_CAPTURE
+  if (millis() - this->last_capture_flush_millis_ >= CAPTURE_FLUSH_INTERVAL) {
+    this->last_capture_flush_millis_ = millis();
+    this->capture_recorder_.flush();
+  }
+#endif
+}
+
+void LD6001Component::read_uart_() {
+  uint8_t buffer[UART_CHUNK_SIZE];
+  uint32_t start = micros();
+  bool ingested = false;
+
+  // Read everything that is available in chunks and hand it to the frame parser at once
+  while (size_t available = this->available()) {
+    size_t len = std::min(available, sizeof(buffer));
+    if (!this->read_array(buffer, len)) {
+      break;
     }
+#ifdef USE_LD6001_CAPTURE
+    this->capture_recorder_.record(millis(), buffer, len);
+#endif
+    this->frame_iter_.push_data(buffer, len);
+    ingested = true;
+  }
+
+  // Calls without data would only drag the average down
+  if (ingested) {
+    this->ingest_stats_.add(micros() - start);
   }
 }
 
+#ifdef USE_LD6001_PARSER_TASK
+void LD6001Component::parser_task_loop_(void *param) {
+  auto *component = static_cast<LD6001Component *>(param);
+
+  while (true) {
+    component->read_uart_();
+    vTaskDelay(1);  // One tick is far less than it takes to fill the UART buffer
+  }
+}
+#endif
+
 void LD6001Component::on_status_response(const StatusResponse &response) {
   std::string version =
       str_sprintf("HW v%d.%02d / SW v%d.%02d", response.hardware_version_major, response.hardware_version_minor,
@@ -95,21 +251,39 @@ void LD6001Component::update() {
     this->send_version_request_();
   }
 
-  this->update_sensors_();
+  if (!this->event_driven_) {
+    this->update_sensors_();
+  }
 }
 
 void LD6001Component::update_sensors_() {
-#ifdef USE_SENSOR
   /*
      Reduce data update rate to prevent home assistant database size grow fast
   */
-  int32_t current_millis = millis();
+  uint32_t current_millis = millis();
   if (current_millis - last_periodic_millis_ < this->throttle_) {
     return;
   }
 
+#ifdef USE_LD6001_WARM_START
+  // The restored state stays until the radar reports, unless it does not for too long
+  if (this->warm_hold_ && !this->frame_pending_ && current_millis < WARM_STATE_HOLD_TIME) {
+    return;
+  }
+  this->warm_hold_ = false;
+#endif
+
   last_periodic_millis_ = current_millis;
+  this->publish_sensors_(current_millis);
+}
+
+void LD6001Component::publish_sensors_(uint32_t current_millis) {
+  if (this->frame_pending_) {
+    this->publish_latency_ms_ = current_millis - this->last_frame_millis_;
+    this->frame_pending_ = false;
+  }
 
+#ifdef USE_SENSOR
   maybe_publish(this->target_count_sensor_, this->target_info_.targets);
 
   uint8_t targets = this->target_info_.targets;
@@ -121,46 +295,105 @@ void LD6001Component::update_sensors_() {
     auto pitch_angle = i < targets ? target.pitch_angle : NAN;
     auto horizontal_angle = i < targets ? target.horizontal_angle : NAN;
 
-    maybe_publish(this->move_x_sensors_[i], coord_x);
-    maybe_publish(this->move_y_sensors_[i], coord_y);
-    maybe_publish(this->move_distance_sensors_[i], distance);
-    maybe_publish(this->move_pitch_angle_sensors_[i], pitch_angle);
-    maybe_publish(this->move_horizontal_angle_sensors_[i], horizontal_angle);
+    this->move_x_sensors_[i].publish(coord_x, current_millis);
+    this->move_y_sensors_[i].publish(coord_y, current_millis);
+    this->move_distance_sensors_[i].publish(distance, current_millis);
+    this->move_pitch_angle_sensors_[i].publish(pitch_angle, current_millis);
+    this->move_horizontal_angle_sensors_[i].publish(horizontal_angle, current_millis);
   }
 
   for (size_t index = 0; index < MAX_ZONES; ++index) {
     auto &zone = this->zone_config_[index];
-    zone.target_count = 0;
+    zone.target_count = zone.count_targets(Span<Target>(this->target_info_.target_data, targets));
+    maybe_publish(this->zone_target_count_sensors_[index], zone.target_count);
+    maybe_publish(this->zone_dwell_time_sensors_[index],
+                  this->zone_occupancy_.get_dwell_time(index, current_millis) / 1000);
+  }
+#endif
 
-    for (size_t i = 0; i < targets; i++) {
-      auto person = this->target_info_.target_data[i];
+  this->update_trigger_.trigger(Span<Target>(this->target_info_.target_data, this->target_info_.targets));
 
-      auto target_id = person.id;
-      auto coord_x = person.x;
-      auto coord_y = person.y;
+#ifdef USE_LD6001_WARM_START
+  this->save_warm_state_(false);
+#endif
+}
 
-      if (zone.contains(coord_x * 100, coord_y * 100)) {
-        zone.target_count++;
-      }
-    }
-    maybe_publish(this->zone_target_count_sensors_[index], zone.target_count);
+#ifdef USE_SENSOR
+void LD6001Component::publish_diagnostics_() {
+  const auto &stats = this->get_parser_stats();
+  uint32_t now = millis();
+  uint32_t frames = stats.get_total_frames();
+
+  if (now != this->last_diagnostics_millis_) {
+    maybe_publish(this->frame_rate_sensor_,
+                  (frames - this->last_diagnostics_frames_) * 1000.0f / (now - this->last_diagnostics_millis_));
   }
-#endif
+  this->last_diagnostics_frames_ = frames;
+  this->last_diagnostics_millis_ = now;
+
+  maybe_publish(this->radar_frames_sensor_, stats.get_frames(FrameType::RADAR));
+  maybe_publish(this->bytes_discarded_sensor_, stats.bytes_discarded);
+  maybe_publish(this->checksum_failures_sensor_, stats.checksum_failures);
+  maybe_publish(this->buffer_overflows_sensor_, stats.buffer_overflows);
 
-  auto people = std::vector<Target>(
-    this->target_info_.target_data,
-    this->target_info_.target_data + this->target_info_.targets
-  );
+  // Ingest times are per interval, so a single slow loop shows up once instead of forever
+  auto ingest = this->ingest_stats_.take();
+  maybe_publish(this->ingest_time_max_sensor_, ingest.count > 0 ? ingest.max_us : NAN);
+  maybe_publish(this->ingest_time_avg_sensor_, ingest.get_average_us());
 
-  this->update_trigger_.trigger(people);
+  maybe_publish(this->publish_latency_sensor_, this->publish_latency_ms_);
 }
+#endif
 
 void LD6001Component::on_radar_response(const RadarResponse &response) {
   this->target_info_.targets = response.targets;
+  this->last_frame_millis_ = millis();
+
+  // The first frame after a publish schedules the next one, later frames only update the state it publishes
+  if (this->event_driven_ && !this->frame_pending_) {
+    this->set_timeout("publish", this->coalesce_window_, [this]() { this->publish_sensors_(millis()); });
+  }
+  this->frame_pending_ = true;
 
   memcpy(this->target_info_.target_data, response.people, sizeof(this->target_info_.target_data));
-  auto people = std::vector<Target>(response.people, response.people + response.targets);
+  Span<Target> people(response.people, response.targets);
   this->target_tracker_.update(people);
+
+  // Zones are followed on every frame so enter and leave events are not held back by the throttle
+  std::array<ZoneOccupancy<Target>::mask_type, MAX_TARGETS> target_zones{};
+  for (uint8_t i = 0; i < response.targets; i++) {
+    for (size_t zone = 0; zone < MAX_ZONES; zone++) {
+      if (this->zone_config_[zone].contains(response.people[i].x, response.people[i].y)) {
+        target_zones[i] |= ZoneOccupancy<Target>::mask_type(1) << zone;
+      }
+    }
+  }
+  this->zone_occupancy_.update(people, target_zones.data(), this->last_frame_millis_);
+
+#ifdef USE_LD6001_HEATMAP
+  for (uint8_t i = 0; i < response.targets && i < MAX_TARGETS; i++) {
+    this->heatmap_.add(response.people[i].x, response.people[i].y);
+  }
+#endif
+}
+
+#ifdef USE_LD6001_HEATMAP
+void LD6001Component::set_heatmap(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t cell_size,
+                                  uint32_t decay_interval, float decay_factor) {
+  if (!this->heatmap_.configure(x1, y1, x2, y2, cell_size)) {
+    ESP_LOGE(TAG, "Heatmap: invalid area (%d, %d) (%d, %d) for cells of %u cm", x1, y1, x2, y2, cell_size);
+  }
+  this->heatmap_decay_interval_ = decay_interval;
+  this->heatmap_decay_factor_ = decay_factor;
+}
+
+void LD6001Component::export_heatmap() { this->heatmap_trigger_.trigger(this->heatmap_.encode()); }
+#endif
+
+void LD6001Component::add_zone_vertex(uint8_t zone, int16_t x, int16_t y) {
+  if (zone >= MAX_ZONES || !this->zone_config_[zone].add_vertex(x, y)) {
+    ESP_LOGE(TAG, "Zone %d: too many vertices, ignoring (%d, %d)", zone, x, y);
+  }
 }
 
 void LD6001Component::on_target_enter(uint8_t target_id) {
@@ -173,6 +406,16 @@ void LD6001Component::on_target_left(uint8_t target_id, uint32_t dwell_time) {
   this->target_left_trigger_.trigger(target_id, dwell_time);
 }
 
+void LD6001Component::on_zone_enter(uint8_t zone, uint8_t target_id) {
+  ESP_LOGD(TAG, "Target %d entered zone %d", target_id, zone + 1);
+  this->zone_enter_trigger_.trigger(zone + 1, target_id);
+}
+
+void LD6001Component::on_zone_left(uint8_t zone, uint8_t target_id, uint32_t dwell_time) {
+  ESP_LOGD(TAG, "Target %d left zone %d, dwell time: %d seconds", target_id, zone + 1, dwell_time);
+  this->zone_left_trigger_.trigger(zone + 1, target_id, dwell_time);
+}
+
 // Get LD6001 firmware version
 void LD6001Component::send_version_request_() {
   ESP_LOGW(TAG, "Sending get version request");
@@ -194,6 +437,11 @@ void LD6001Component::set_zone_coordinate(uint8_t zone) {
     return;
   }
 
+  if (this->zone_config_[zone].is_polygon()) {
+    ESP_LOGW(TAG, "Zone %d is a polygon, ignoring its coordinate numbers", zone);
+    return;
+  }
+
   ESP_LOGW(TAG, "Set new coordinates for zone %d: (%d, %d) (%d, %d)", zone, static_cast<int>(x1sens->state),
            static_cast<int>(y1sens->state), static_cast<int>(x2sens->state), static_cast<int>(y2sens->state));
 
@@ -215,20 +463,37 @@ void LD6001Component::set_zone_numbers(uint8_t zone, number::Number *x1, number:
 #endif
 
 #ifdef USE_SENSOR
-void LD6001Component::set_move_x_sensor(uint8_t target, sensor::Sensor *s) { this->move_x_sensors_[target] = s; }
-void LD6001Component::set_move_y_sensor(uint8_t target, sensor::Sensor *s) { this->move_y_sensors_[target] = s; }
-void LD6001Component::set_move_pitch_angle_sensor(uint8_t target, sensor::Sensor *s) {
-  this->move_pitch_angle_sensors_[target] = s;
+void LD6001Component::set_move_x_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                        uint32_t max_interval) {
+  this->move_x_sensors_[target].sensor = s;
+  this->move_x_sensors_[target].filter.configure(min_delta, max_interval);
 }
-void LD6001Component::set_move_horizontal_angle_sensor(uint8_t target, sensor::Sensor *s) {
-  this->move_horizontal_angle_sensors_[target] = s;
+void LD6001Component::set_move_y_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                        uint32_t max_interval) {
+  this->move_y_sensors_[target].sensor = s;
+  this->move_y_sensors_[target].filter.configure(min_delta, max_interval);
 }
-void LD6001Component::set_move_distance_sensor(uint8_t target, sensor::Sensor *s) {
-  this->move_distance_sensors_[target] = s;
+void LD6001Component::set_move_pitch_angle_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                                  uint32_t max_interval) {
+  this->move_pitch_angle_sensors_[target].sensor = s;
+  this->move_pitch_angle_sensors_[target].filter.configure(min_delta, max_interval);
+}
+void LD6001Component::set_move_horizontal_angle_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                                       uint32_t max_interval) {
+  this->move_horizontal_angle_sensors_[target].sensor = s;
+  this->move_horizontal_angle_sensors_[target].filter.configure(min_delta, max_interval);
+}
+void LD6001Component::set_move_distance_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                               uint32_t max_interval) {
+  this->move_distance_sensors_[target].sensor = s;
+  this->move_distance_sensors_[target].filter.configure(min_delta, max_interval);
 }
 void LD6001Component::set_zone_target_count_sensor(uint8_t zone, sensor::Sensor *s) {
   this->zone_target_count_sensors_[zone] = s;
 }
+void LD6001Component::set_zone_dwell_time_sensor(uint8_t zone, sensor::Sensor *s) {
+  this->zone_dwell_time_sensors_[zone] = s;
+}
 #endif
 
 }  // namespace ld6001
@@ -11,6 +11,18 @@
 #include "esphome/core/preferences.h"
 #include "frame_parser.h"
 #include "target_tracker.h"
+#include "zone.h"
+#include "zone_occupancy.h"
+#include "heatmap.h"
+#include "capture.h"
+#include "publish_filter.h"
+#include "warm_start.h"
+
+#ifdef USE_LD6001_PARSER_TASK
+#include "frame_event_queue.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
 
 #ifdef USE_SENSOR
 #include "esphome/components/sensor/sensor.h"
@@ -44,6 +56,13 @@ namespace ld6001 {
 // Constants
 static const uint8_t DEFAULT_PRESENCE_TIMEOUT = 5;  // Timeout to reset presense status 5 sec.
 static const uint16_t MAX_LINE_LENGTH = 1024;          // Max characters for serial buffer
+static const size_t UART_CHUNK_SIZE = 128;             // Max bytes read from the UART in one go
+static const size_t PARSER_TASK_QUEUE_SIZE = 4;        // Parsed frames buffered between the parser task and loop()
+static const uint32_t PARSER_TASK_STACK_SIZE = 4096;
+static const size_t CAPTURE_BUFFER_SIZE = 512;         // UART capture bytes handed to on_capture at once
+static const uint32_t CAPTURE_FLUSH_INTERVAL = 1000;   // Max ms a captured read waits in the buffer
+static const uint32_t DIAGNOSTICS_INTERVAL = 10000;    // Publish interval of the link health sensors
+static const uint32_t WARM_STATE_HOLD_TIME = 30000;    // Max ms the restored state is kept while no frame arrives
 static const uint8_t MAX_ZONES = 4;                 // Max 3 Zones in LD6001
 
 struct TargetInfo {
@@ -51,18 +70,19 @@ struct TargetInfo {
   Target target_data[MAX_TARGETS];
 };
 
-// Zone coordinate struct
-struct Zone {
-  int16_t x1 = 0;
-  int16_t y1 = 0;
-  int16_t x2 = 0;
-  int16_t y2 = 0;
-  uint8_t target_count = 0;
+#ifdef USE_SENSOR
+// Per target sensor together with the state that decides which of its values are published
+struct FilteredSensor {
+  sensor::Sensor *sensor = nullptr;
+  PublishFilter filter;
 
-  bool contains(const int16_t x, const int16_t y) const {
-    return (x >= this->x1 && x <= this->x2 && y >= this->y1 && y <= this->y2);
+  void publish(float value, uint32_t now) {
+    if (this->sensor != nullptr && this->filter.update(value, now)) {
+      this->sensor->publish_state(value);
+    }
   }
 };
+#endif
 
 #ifdef USE_NUMBER
 struct ZoneOfNumbers {
@@ -73,9 +93,19 @@ struct ZoneOfNumbers {
 };
 #endif
 
-class LD6001Component : public PollingComponent, public uart::UARTDevice, public FrameHandler, public TargetEventHandler<uint8_t> {
+class LD6001Component : public PollingComponent, public uart::UARTDevice, public FrameHandler, public TargetEventHandler<uint8_t>,
+                        protected ZoneEventHandler<uint8_t> {
 #ifdef USE_SENSOR
   SUB_SENSOR(target_count)
+
+  SUB_SENSOR(frame_rate)
+  SUB_SENSOR(radar_frames)
+  SUB_SENSOR(bytes_discarded)
+  SUB_SENSOR(checksum_failures)
+  SUB_SENSOR(buffer_overflows)
+  SUB_SENSOR(ingest_time_max)
+  SUB_SENSOR(ingest_time_avg)
+  SUB_SENSOR(publish_latency)
 #endif
 
 #ifdef USE_TEXT_SENSOR
@@ -89,26 +119,65 @@ class LD6001Component : public PollingComponent, public uart::UARTDevice, public
   void dump_config() override;
   void loop() override;
   void update() override;
+  void on_shutdown() override;
 
   void set_throttle(uint16_t value) { this->throttle_ = value; };
+  // Publishes once per radar frame instead of on the polling tick, frames within the window are published together
+  void set_coalesce_window(uint32_t window) {
+    this->event_driven_ = true;
+    this->coalesce_window_ = window;
+  }
+  void set_parser_task(bool parser_task) { this->parser_task_ = parser_task; }
+  void add_zone_vertex(uint8_t zone, int16_t x, int16_t y);
+
+  // Seconds the zone has been occupied without interruption, 0 while it is empty
+  uint32_t get_zone_dwell_time(uint8_t zone) const { return this->zone_occupancy_.get_dwell_time(zone, millis()) / 1000; }
+  // Seconds the zone has been occupied in total since boot
+  uint32_t get_zone_occupied_time(uint8_t zone) const {
+    return this->zone_occupancy_.get_total_time(zone, millis()) / 1000;
+  }
+
+  const ParserStats &get_parser_stats() const { return this->frame_iter_.get_stats(); }
 
   void on_radar_response(const RadarResponse &response) override;
   void on_status_response(const StatusResponse &response) override;
 
   virtual void on_target_enter(uint8_t target_id) override;
   virtual void on_target_left(uint8_t target_id, uint32_t dwell_time) override;
+  virtual void on_zone_enter(uint8_t zone, uint8_t target_id) override;
+  virtual void on_zone_left(uint8_t zone, uint8_t target_id, uint32_t dwell_time) override;
 
   Trigger<uint8_t> *get_target_enter_trigger() { return &this->target_enter_trigger_; }
   Trigger<uint8_t, uint32_t> *get_target_left_trigger() { return &this->target_left_trigger_; }
-  Trigger<const std::vector<Target> &> *get_update_trigger() { return &this->update_trigger_; }
+  Trigger<uint8_t, uint8_t> *get_zone_enter_trigger() { return &this->zone_enter_trigger_; }
+  Trigger<uint8_t, uint8_t, uint32_t> *get_zone_left_trigger() { return &this->zone_left_trigger_; }
+  Trigger<Span<Target>> *get_update_trigger() { return &this->update_trigger_; }
+  Trigger<std::vector<uint8_t>> *get_capture_trigger() { return &this->capture_trigger_; }
+  Trigger<std::vector<uint8_t>> *get_heatmap_trigger() { return &this->heatmap_trigger_; }
+
+#ifdef USE_LD6001_WARM_START
+  // Keeps the occupancy in flash to publish it right after a reboot, saved at most every save_interval ms
+  void set_warm_start(uint32_t save_interval) { this->warm_start_.set_interval(save_interval); }
+#endif
+
+#ifdef USE_LD6001_HEATMAP
+  // Area and cell size in cm, decay_factor is applied every decay_interval ms, 0 never decays
+  void set_heatmap(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t cell_size, uint32_t decay_interval,
+                   float decay_factor);
+  // Hands the heatmap to on_export, e.g. from a button or API service
+  void export_heatmap();
+  void clear_heatmap() { this->heatmap_.clear(); }
+#endif
 
 #ifdef USE_SENSOR
-  void set_move_x_sensor(uint8_t target, sensor::Sensor *s);
-  void set_move_y_sensor(uint8_t target, sensor::Sensor *s);
-  void set_move_pitch_angle_sensor(uint8_t target, sensor::Sensor *s);
-  void set_move_horizontal_angle_sensor(uint8_t target, sensor::Sensor *s);
-  void set_move_distance_sensor(uint8_t target, sensor::Sensor *s);
+  void set_move_x_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
+  void set_move_y_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
+  void set_move_pitch_angle_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
+  void set_move_horizontal_angle_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0,
+                                        uint32_t max_interval = 0);
+  void set_move_distance_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
   void set_zone_target_count_sensor(uint8_t zone, sensor::Sensor *s);
+  void set_zone_dwell_time_sensor(uint8_t zone, sensor::Sensor *s);
 #endif
 
 #ifdef USE_NUMBER
@@ -121,26 +190,76 @@ protected:
   void send_radar_request_();
 
   void update_sensors_();
+  void publish_sensors_(uint32_t now);
+  void read_uart_();
   void read_version_frame_(const std::vector<uint8_t> &buffer);
   void read_radar_frame_(const uint8_t *buffer);
   void update_last_seen_(uint8_t target_id);
+#ifdef USE_SENSOR
+  void publish_diagnostics_();
+#endif
+#ifdef USE_LD6001_WARM_START
+  void restore_warm_state_();
+  void save_warm_state_(bool force);
+#endif
 
   TargetTracker<Target> target_tracker_{*this};
   Trigger<uint8_t> target_enter_trigger_;
   Trigger<uint8_t, uint32_t> target_left_trigger_;
-  Trigger<const std::vector<Target> &> update_trigger_;
+  Trigger<uint8_t, uint8_t> zone_enter_trigger_;
+  Trigger<uint8_t, uint8_t, uint32_t> zone_left_trigger_;
+  Trigger<Span<Target>> update_trigger_;
+  Trigger<std::vector<uint8_t>> capture_trigger_;
 
   TargetInfo target_info_ = {};
   Zone zone_config_[MAX_ZONES];
+  ZoneOccupancy<Target> zone_occupancy_{*this};
   uint32_t last_periodic_millis_ = 0;
   uint32_t presence_millis_ = 0;
   uint32_t still_presence_millis_ = 0;
   uint32_t moving_presence_millis_ = 0;
   uint16_t throttle_ = 1000;
+  bool event_driven_ = false;
+  uint32_t coalesce_window_ = 0;
   uint16_t timeout_ = 5;
 
   FrameParser frame_iter_;
 
+  IngestStats ingest_stats_;
+  uint32_t last_frame_millis_ = 0;    // When the last radar frame arrived
+  uint32_t publish_latency_ms_ = 0;   // Age of the last radar frame when the sensors were last published
+  bool frame_pending_ = false;        // A radar frame arrived since the sensors were last published
+  uint32_t last_diagnostics_frames_ = 0;
+  uint32_t last_diagnostics_millis_ = 0;
+
+  bool parser_task_ = false;
+#ifdef USE_LD6001_PARSER_TASK
+  static void parser_task_loop_(void *param);
+
+  FrameEventQueue<PARSER_TASK_QUEUE_SIZE> frame_events_;
+  TaskHandle_t parser_task_handle_ = nullptr;
+#endif
+
+#ifdef USE_LD6001_CAPTURE
+  CaptureRecorder<CAPTURE_BUFFER_SIZE> capture_recorder_{[this](const uint8_t *data, size_t len) {
+    this->capture_trigger_.trigger(std::vector<uint8_t>(data, data + len));
+  }};
+  uint32_t last_capture_flush_millis_ = 0;
+#endif
+
+  Trigger<std::vector<uint8_t>> heatmap_trigger_;
+#ifdef USE_LD6001_HEATMAP
+  Heatmap heatmap_;
+  uint32_t heatmap_decay_interval_ = 0;
+  float heatmap_decay_factor_ = 1.0f;
+#endif
+
+#ifdef USE_LD6001_WARM_START
+  WarmStart<MAX_ZONES> warm_start_;
+  ESPPreferenceObject warm_pref_;
+  bool warm_hold_ = false;  // Restored state published, no radar frame since
+#endif
+
   uint8_t zone_type_ = 0;
   std::string version_{};
   std::string mac_{};
@@ -149,12 +268,13 @@ protected:
   ZoneOfNumbers zone_numbers_[MAX_ZONES];
 #endif
 #ifdef USE_SENSOR
-  std::vector<sensor::Sensor *> move_x_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> move_y_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> move_pitch_angle_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> move_horizontal_angle_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> move_distance_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
+  std::array<FilteredSensor, MAX_TARGETS> move_x_sensors_{};
+  std::array<FilteredSensor, MAX_TARGETS> move_y_sensors_{};
+  std::array<FilteredSensor, MAX_TARGETS> move_pitch_angle_sensors_{};
+  std::array<FilteredSensor, MAX_TARGETS> move_horizontal_angle_sensors_{};
+  std::array<FilteredSensor, MAX_TARGETS> move_distance_sensors_{};
   std::vector<sensor::Sensor *> zone_target_count_sensors_ = std::vector<sensor::Sensor *>(MAX_ZONES);
+  std::vector<sensor::Sensor *> zone_dwell_time_sensors_ = std::vector<sensor::Sensor *>(MAX_ZONES);
 #endif
 };
 
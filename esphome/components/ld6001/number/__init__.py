@@ -10,7 +10,7 @@ from esphome.const import (
     UNIT_SECOND,
 )
 
-from .. import CONF_LD6001_ID, LD6001Component, ld6001_ns
+from .. import CONF_LD6001_ID, LD6001Component, ld6001_ns, MAX_ZONES
 
 CONF_PRESENCE_TIMEOUT = "presence_timeout"
 CONF_X1 = "x1"
@@ -21,7 +21,6 @@ ICON_ARROW_BOTTOM_RIGHT = "mdi:arrow-bottom-right"
 ICON_ARROW_BOTTOM_RIGHT_BOLD_BOX_OUTLINE = "mdi:arrow-bottom-right-bold-box-outline"
 ICON_ARROW_TOP_LEFT = "mdi:arrow-top-left"
 ICON_ARROW_TOP_LEFT_BOLD_BOX_OUTLINE = "mdi:arrow-top-left-bold-box-outline"
-MAX_ZONES = 4
 
 PresenceTimeoutNumber = ld6001_ns.class_("PresenceTimeoutNumber", number.Number)
 ZoneCoordinateNumber = ld6001_ns.class_("ZoneCoordinateNumber", number.Number)
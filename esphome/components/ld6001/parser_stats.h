@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace ld6001 {
+
+enum class FrameType : uint8_t { STATUS, RADAR, COUNT };
+
+// Counter with a single writer and any number of readers on other threads. The relaxed atomic makes a read slightly
+// stale at worst, never torn. Incrementing is a plain load and store, which is only safe with one writer.
+class Counter {
+ public:
+  Counter() = default;
+  Counter(const Counter &other) : value_(other) {}
+  Counter &operator=(const Counter &other) {
+    this->value_.store(other, std::memory_order_relaxed);
+    return *this;
+  }
+
+  operator uint32_t() const { return this->value_.load(std::memory_order_relaxed); }
+
+  Counter &operator+=(uint32_t count) {
+    this->value_.store(this->value_.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    return *this;
+  }
+  Counter &operator++() { return *this += 1; }
+  void operator++(int) { *this += 1; }
+
+ protected:
+  std::atomic<uint32_t> value_{0};
+};
+
+// Link health counters of the frame parser. They only ever go up, consumers look at the difference between two reads.
+//
+// With the parser task enabled they are written by the task and read from loop(), see Counter.
+struct ParserStats {
+  std::array<Counter, static_cast<size_t>(FrameType::COUNT)> frames{};  // Frames parsed, per type
+  Counter bytes_discarded;    // Bytes skipped while looking for the start of a frame
+  Counter checksum_failures;  // Frames thrown away because of a bad checksum
+  Counter buffer_overflows;   // Times the buffer was full and incoming bytes were dropped
+
+  void count_frame(FrameType type) { this->frames[static_cast<size_t>(type)]++; }
+  uint32_t get_frames(FrameType type) const { return this->frames[static_cast<size_t>(type)]; }
+
+  uint32_t get_total_frames() const {
+    uint32_t total = 0;
+    for (const auto &count : this->frames) {
+      total += count;
+    }
+    return total;
+  }
+};
+
+// Time spent reading and parsing UART data, in µs, per interval
+//
+// With the parser task enabled, add() runs on the task while take() runs in loop(). The sum and the count share one
+// atomic word, so an interval never pairs the sum of one interval with the count of another, and no update is lost.
+class IngestStats {
+ public:
+  struct Interval {
+    uint32_t max_us = 0;
+    uint64_t total_us = 0;
+    uint32_t count = 0;
+
+    float get_average_us() const { return this->count > 0 ? float(this->total_us) / this->count : NAN; }
+  };
+
+  void add(uint32_t us) {
+    this->sum_.fetch_add((uint64_t(1) << COUNT_SHIFT) | us, std::memory_order_relaxed);
+
+    uint32_t max = this->max_us_.load(std::memory_order_relaxed);
+    while (us > max && !this->max_us_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Returns the times added since the last call and starts a new interval
+  Interval take() {
+    uint64_t sum = this->sum_.exchange(0, std::memory_order_relaxed);
+
+    Interval interval;
+    interval.max_us = this->max_us_.exchange(0, std::memory_order_relaxed);
+    interval.total_us = sum & ((uint64_t(1) << COUNT_SHIFT) - 1);
+    interval.count = sum >> COUNT_SHIFT;
+    return interval;
+  }
+
+ protected:
+  static constexpr unsigned COUNT_SHIFT = 40;  // Low bits hold the total, enough for 12 days in µs
+
+  std::atomic<uint64_t> sum_{0};  // Count in the high bits, total µs in the low bits
+  std::atomic<uint32_t> max_us_{0};
+};
+
+}  // namespace ld6001
+}  // namespace esphome
@@ -5,12 +5,18 @@ from esphome.const import (
     CONF_ANGLE,
     CONF_DISTANCE,
     DEVICE_CLASS_DISTANCE,
+    DEVICE_CLASS_DURATION,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
     UNIT_CENTIMETER,
     UNIT_DEGREES,
     UNIT_MILLIMETER,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
 )
 
-from . import CONF_LD6001_ID, LD6001Component
+from . import CONF_LD6001_ID, LD6001Component, MAX_ZONES
 
 DEPENDENCIES = ["ld6001"]
 
@@ -19,8 +25,20 @@ CONF_HORIZONTAL_ANGLE = "horizontal_angle"
 CONF_MOVING_TARGET_COUNT = "moving_target_count"
 CONF_STILL_TARGET_COUNT = "still_target_count"
 CONF_TARGET_COUNT = "target_count"
+CONF_DWELL_TIME = "dwell_time"
 CONF_X = "x"
 CONF_Y = "y"
+CONF_MIN_DELTA = "min_delta"
+CONF_MAX_INTERVAL = "max_interval"
+
+CONF_FRAME_RATE = "frame_rate"
+CONF_RADAR_FRAMES = "radar_frames"
+CONF_BYTES_DISCARDED = "bytes_discarded"
+CONF_CHECKSUM_FAILURES = "checksum_failures"
+CONF_BUFFER_OVERFLOWS = "buffer_overflows"
+CONF_INGEST_TIME_MAX = "ingest_time_max"
+CONF_INGEST_TIME_AVG = "ingest_time_avg"
+CONF_PUBLISH_LATENCY = "publish_latency"
 
 ICON_ACCOUNT_GROUP = "mdi:account-group"
 ICON_ACCOUNT_SWITCH = "mdi:account-switch"
@@ -33,11 +51,65 @@ ICON_MAP_MARKER_ACCOUNT = "mdi:map-marker-account"
 ICON_MAP_MARKER_DISTANCE = "mdi:map-marker-distance"
 ICON_RELATION_ZERO_OR_ONE_TO_ZERO_OR_ONE = "mdi:relation-zero-or-one-to-zero-or-one"
 ICON_SPEEDOMETER_SLOW = "mdi:speedometer-slow"
+ICON_COUNTER = "mdi:counter"
+ICON_TIMER_OUTLINE = "mdi:timer-outline"
+ICON_ALERT_CIRCLE_OUTLINE = "mdi:alert-circle-outline"
 
 MAX_TARGETS = 10
-MAX_ZONES = 4
 
 UNIT_MILLIMETER_PER_SECOND = "mm/s"
+UNIT_FRAMES_PER_SECOND = "frames/s"
+UNIT_MICROSECOND = "µs"
+
+
+def diagnostic_counter_schema(icon):
+    return sensor.sensor_schema(
+        icon=icon,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
+def diagnostic_duration_schema(unit):
+    return sensor.sensor_schema(
+        device_class=DEVICE_CLASS_DURATION,
+        unit_of_measurement=unit,
+        icon=ICON_TIMER_OUTLINE,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
+def target_sensor_schema(**kwargs):
+    # Target coordinates change with every frame, only publish changes of at least min_delta, or the current value
+    # once max_interval has passed
+    return sensor.sensor_schema(**kwargs).extend(
+        {
+            cv.Optional(CONF_MIN_DELTA, default=0): cv.positive_float,
+            cv.Optional(CONF_MAX_INTERVAL, default="0s"): cv.positive_time_period_milliseconds,
+        }
+    )
+
+
+# Link health, published every 10s. Counters run from boot, ingest times cover the last interval.
+DIAGNOSTIC_SENSORS = {
+    CONF_FRAME_RATE: sensor.sensor_schema(
+        unit_of_measurement=UNIT_FRAMES_PER_SECOND,
+        icon=ICON_SPEEDOMETER_SLOW,
+        accuracy_decimals=1,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_RADAR_FRAMES: diagnostic_counter_schema(ICON_COUNTER),
+    CONF_BYTES_DISCARDED: diagnostic_counter_schema(ICON_ALERT_CIRCLE_OUTLINE),
+    CONF_CHECKSUM_FAILURES: diagnostic_counter_schema(ICON_ALERT_CIRCLE_OUTLINE),
+    CONF_BUFFER_OVERFLOWS: diagnostic_counter_schema(ICON_ALERT_CIRCLE_OUTLINE),
+    CONF_INGEST_TIME_MAX: diagnostic_duration_schema(UNIT_MICROSECOND),
+    CONF_INGEST_TIME_AVG: diagnostic_duration_schema(UNIT_MICROSECOND),
+    CONF_PUBLISH_LATENCY: diagnostic_duration_schema(UNIT_MILLISECOND),
+}
 
 CONFIG_SCHEMA = cv.Schema(
     {
@@ -51,6 +123,7 @@ CONFIG_SCHEMA = cv.Schema(
         cv.Optional(CONF_MOVING_TARGET_COUNT): sensor.sensor_schema(
             icon=ICON_ACCOUNT_SWITCH,
         ),
+        **{cv.Optional(key): schema for key, schema in DIAGNOSTIC_SENSORS.items()},
     }
 )
 
@@ -58,25 +131,25 @@ CONFIG_SCHEMA = CONFIG_SCHEMA.extend(
     {
         cv.Optional(f"target_{n + 1}"): cv.Schema(
             {
-                cv.Optional(CONF_X): sensor.sensor_schema(
+                cv.Optional(CONF_X): target_sensor_schema(
                     device_class=DEVICE_CLASS_DISTANCE,
                     unit_of_measurement=UNIT_CENTIMETER,
                     icon=ICON_ALPHA_X_BOX_OUTLINE,
                 ),
-                cv.Optional(CONF_Y): sensor.sensor_schema(
+                cv.Optional(CONF_Y): target_sensor_schema(
                     device_class=DEVICE_CLASS_DISTANCE,
                     unit_of_measurement=UNIT_CENTIMETER,
                     icon=ICON_ALPHA_Y_BOX_OUTLINE,
                 ),
-                cv.Optional(CONF_PITCH_ANGLE): sensor.sensor_schema(
+                cv.Optional(CONF_PITCH_ANGLE): target_sensor_schema(
                     unit_of_measurement=UNIT_DEGREES,
                     icon=ICON_FORMAT_TEXT_ROTATION_ANGLE_UP,
                 ),
-                cv.Optional(CONF_HORIZONTAL_ANGLE): sensor.sensor_schema(
+                cv.Optional(CONF_HORIZONTAL_ANGLE): target_sensor_schema(
                     unit_of_measurement=UNIT_DEGREES,
                     icon=ICON_ANGLE_ACUTE,
                 ),
-                cv.Optional(CONF_DISTANCE): sensor.sensor_schema(
+                cv.Optional(CONF_DISTANCE): target_sensor_schema(
                     device_class=DEVICE_CLASS_DISTANCE,
                     unit_of_measurement=UNIT_CENTIMETER,
                     icon=ICON_MAP_MARKER_DISTANCE,
@@ -91,6 +164,13 @@ CONFIG_SCHEMA = CONFIG_SCHEMA.extend(
                 cv.Optional(CONF_TARGET_COUNT): sensor.sensor_schema(
                     icon=ICON_MAP_MARKER_ACCOUNT,
                 ),
+                cv.Optional(CONF_DWELL_TIME): sensor.sensor_schema(
+                    device_class=DEVICE_CLASS_DURATION,
+                    unit_of_measurement=UNIT_SECOND,
+                    icon=ICON_TIMER_OUTLINE,
+                    accuracy_decimals=0,
+                    state_class=STATE_CLASS_MEASUREMENT,
+                ),
             }
         )
         for n in range(MAX_ZONES)
@@ -105,26 +185,54 @@ async def to_code(config):
         sens = await sensor.new_sensor(target_count_config)
         cg.add(ld6001_component.set_target_count_sensor(sens))
 
+    for key in DIAGNOSTIC_SENSORS:
+        if diagnostic_config := config.get(key):
+            sens = await sensor.new_sensor(diagnostic_config)
+            cg.add(getattr(ld6001_component, f"set_{key}_sensor")(sens))
+
     for n in range(MAX_TARGETS):
         if target_conf := config.get(f"target_{n + 1}"):
             if x_config := target_conf.get(CONF_X):
                 sens = await sensor.new_sensor(x_config)
-                cg.add(ld6001_component.set_move_x_sensor(n, sens))
+                cg.add(
+                    ld6001_component.set_move_x_sensor(
+                        n, sens, x_config[CONF_MIN_DELTA], x_config[CONF_MAX_INTERVAL]
+                    )
+                )
             if y_config := target_conf.get(CONF_Y):
                 sens = await sensor.new_sensor(y_config)
-                cg.add(ld6001_component.set_move_y_sensor(n, sens))
+                cg.add(
+                    ld6001_component.set_move_y_sensor(
+                        n, sens, y_config[CONF_MIN_DELTA], y_config[CONF_MAX_INTERVAL]
+                    )
+                )
             if angle_config := target_conf.get(CONF_PITCH_ANGLE):
                 sens = await sensor.new_sensor(angle_config)
-                cg.add(ld6001_component.set_move_pitch_angle_sensor(n, sens))
+                cg.add(
+                    ld6001_component.set_move_pitch_angle_sensor(
+                        n, sens, angle_config[CONF_MIN_DELTA], angle_config[CONF_MAX_INTERVAL]
+                    )
+                )
             if angle_config := target_conf.get(CONF_HORIZONTAL_ANGLE):
                 sens = await sensor.new_sensor(angle_config)
-                cg.add(ld6001_component.set_move_horizontal_angle_sensor(n, sens))
+                cg.add(
+                    ld6001_component.set_move_horizontal_angle_sensor(
+                        n, sens, angle_config[CONF_MIN_DELTA], angle_config[CONF_MAX_INTERVAL]
+                    )
+                )
             if distance_config := target_conf.get(CONF_DISTANCE):
                 sens = await sensor.new_sensor(distance_config)
-                cg.add(ld6001_component.set_move_distance_sensor(n, sens))
+                cg.add(
+                    ld6001_component.set_move_distance_sensor(
+                        n, sens, distance_config[CONF_MIN_DELTA], distance_config[CONF_MAX_INTERVAL]
+                    )
+                )
 
     for n in range(MAX_ZONES):
         if zone_config := config.get(f"zone_{n + 1}"):
             if target_count_config := zone_config.get(CONF_TARGET_COUNT):
                 sens = await sensor.new_sensor(target_count_config)
                 cg.add(ld6001_component.set_zone_target_count_sensor(n, sens))
+            if dwell_time_config := zone_config.get(CONF_DWELL_TIME):
+                sens = await sensor.new_sensor(dwell_time_config)
+                cg.add(ld6001_component.set_zone_dwell_time_sensor(n, sens))
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <stdint.h>
+#include <cstddef>
+
+namespace esphome {
+namespace ld6001 {
+
+// Lock-free queue for exactly one producer and one consumer thread, e.g. a parser task and the main loop.
+//
+// Items live in a fixed array, the producer only writes tail_ and the consumer only writes head_. An item is
+// published by the release store on tail_, so the consumer never sees a half written item.
+template<typename T, size_t N> class SpscQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+
+ public:
+  // Producer side, returns false (and counts the item as dropped) when the queue is full
+  bool push(const T &item) {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+
+    if (tail - this->head_.load(std::memory_order_acquire) == N) {
+      this->dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    this->items_[tail & (N - 1)] = item;
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side, returns false when the queue is empty
+  bool pop(T &item) {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+
+    if (head == this->tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    item = this->items_[head & (N - 1)];
+    this->head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return this->head_.load(std::memory_order_acquire) == this->tail_.load(std::memory_order_acquire);
+  }
+
+  uint32_t get_dropped() const { return this->dropped_.load(std::memory_order_relaxed); }
+
+ protected:
+  std::array<T, N> items_{};
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace ld6001
+}  // namespace esphome
@@ -1,9 +1,10 @@
 #pragma once
 
-#include <queue>
+#include <array>
 #include <cinttypes>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstddef>
+#include <utility>
+#include "esphome/core/hal.h"
 
 namespace esphome {
 namespace ld6001 {
@@ -15,48 +16,133 @@ class TargetEventHandler {
   virtual void on_target_left(T target_id, uint32_t dwell_time) = 0;
 };
 
-template<typename T>
+// Keeps track of the targets in view to report targets entering and leaving.
+//
+// Targets are kept in a fixed table of N slots and found through a small open addressing index on their id. A
+// bitmask marks the slots seen in the current frame, so an update is O(N) and never allocates.
+template<typename T, size_t N = 16>
 class TargetTracker {
   using id_type = decltype(std::declval<T>().id);
+  using mask_type = uint32_t;
+
+  static_assert(N <= sizeof(mask_type) * 8, "Slot mask is too small for this many targets");
+
+  struct Slot {
+    T target;
+    uint32_t entry_time;
+    uint32_t last_seen_time;
+  };
 
  public:
-  TargetTracker(TargetEventHandler<id_type> &event_handler) : event_handler_(event_handler) {}
+  TargetTracker(TargetEventHandler<id_type> &event_handler) : event_handler_(event_handler) {
+    this->index_.fill(EMPTY);
+  }
 
-  template<typename Container> void update(const Container &targets) {
-    auto now = millis();
-    auto unseen = std::unordered_set<id_type>();
+  template<typename Container> void update(const Container &targets) { this->update(targets, millis()); }
 
-    for (const auto &[key, _] : targets_) {
-      unseen.insert(key);
-    }
+  template<typename Container> void update(const Container &targets, uint32_t now) {
+    mask_type seen = 0;
 
+    // Refresh the targets we already know about
     for (const auto &target : targets) {
-      unseen.erase(target.id);
-      targets_[target.id] = target;
+      int slot = this->find_(target.id);
 
-      if (entry_times_.find(target.id) == entry_times_.end()) {
-        entry_times_[target.id] = now;
-        event_handler_.on_target_enter(target.id);
+      if (slot != EMPTY) {
+        this->slots_[slot].target = target;
+        this->slots_[slot].last_seen_time = now;
+        seen |= mask_type(1) << slot;
       }
+    }
+
+    // Release the ones that are gone first, so their slots can be reused by new targets in the same frame
+    mask_type gone = this->used_ & ~seen;
+    for (size_t slot = 0, left = gone; left != 0; slot++, left >>= 1) {
+      if (left & 1) {
+        const auto &target = this->slots_[slot].target;
+        uint32_t dwell_time = (now - this->slots_[slot].entry_time) / 1000;
 
-      last_seen_times_[target.id] = now;
+        this->used_ &= ~(mask_type(1) << slot);
+        event_handler_.on_target_left(target.id, dwell_time);
+      }
     }
 
-    for (const auto &target_id : unseen) {
-      if (entry_times_.find(target_id) != entry_times_.end()) {
-        uint32_t dwell_time = (now - entry_times_[target_id]) / 1000;
-        event_handler_.on_target_left(target_id, dwell_time);
-        entry_times_.erase(target_id);
-        last_seen_times_.erase(target_id);
+    if (gone != 0) {
+      this->rebuild_index_();
+    }
+
+    for (const auto &target : targets) {
+      if (this->find_(target.id) != EMPTY) {
+        continue;
+      }
+
+      int slot = this->allocate_(target.id);
+      if (slot == EMPTY) {
+        continue;  // More targets than slots, ignore the rest
       }
+
+      this->slots_[slot] = Slot{target, now, now};
+      event_handler_.on_target_enter(target.id);
     }
   }
 
+  size_t size() const { return __builtin_popcount(this->used_); }
+  bool contains(id_type id) const { return this->find_(id) != EMPTY; }
+
  protected:
-  std::unordered_map<id_type, T> targets_;
+  static constexpr int8_t EMPTY = -1;
+  static constexpr size_t INDEX_SIZE = 2 * N;
+
+  size_t hash_(id_type id) const { return (static_cast<uint32_t>(id) * 2654435761u) % INDEX_SIZE; }
+
+  int find_(id_type id) const {
+    for (size_t i = 0, pos = this->hash_(id); i < INDEX_SIZE; i++, pos = (pos + 1) % INDEX_SIZE) {
+      int8_t slot = this->index_[pos];
+      if (slot == EMPTY) {
+        return EMPTY;
+      }
+      if (this->slots_[slot].target.id == id) {
+        return slot;
+      }
+    }
+    return EMPTY;
+  }
+
+  int allocate_(id_type id) {
+    if (this->used_ == ALL_USED) {
+      return EMPTY;
+    }
+
+    int slot = __builtin_ctz(~this->used_);
+    this->used_ |= mask_type(1) << slot;
+    this->slots_[slot].target.id = id;
+    this->insert_index_(id, slot);
+    return slot;
+  }
+
+  void insert_index_(id_type id, int8_t slot) {
+    size_t pos = this->hash_(id);
+    while (this->index_[pos] != EMPTY) {
+      pos = (pos + 1) % INDEX_SIZE;
+    }
+    this->index_[pos] = slot;
+  }
+
+  // Open addressing does not allow plain removal, with at most N entries rebuilding is cheap enough
+  void rebuild_index_() {
+    this->index_.fill(EMPTY);
+    for (size_t slot = 0; slot < N; slot++) {
+      if (this->used_ & (mask_type(1) << slot)) {
+        this->insert_index_(this->slots_[slot].target.id, slot);
+      }
+    }
+  }
+
+  static constexpr mask_type ALL_USED = N == sizeof(mask_type) * 8 ? ~mask_type(0) : (mask_type(1) << N) - 1;
+
   TargetEventHandler<id_type> &event_handler_;
-  std::unordered_map<id_type, uint32_t> entry_times_;
-  std::unordered_map<id_type, uint32_t> last_seen_times_;
+  std::array<Slot, N> slots_{};
+  std::array<int8_t, INDEX_SIZE> index_{};
+  mask_type used_ = 0;
 };
-}  // namespace ld6001a
-}  // namespace esphome
\ No newline at end of file
+}  // namespace ld6001
+}  // namespace esphome
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace ld6001 {
+
+// FNV-1a over the raw bytes of the values added, to tell whether the configuration changed between boots
+class Fingerprint {
+ public:
+  template<typename T> Fingerprint &add(const T &value) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+    for (size_t i = 0; i < sizeof(T); i++) {
+      this->hash_ = (this->hash_ ^ bytes[i]) * 16777619u;
+    }
+    return *this;
+  }
+
+  uint32_t get() const { return this->hash_; }
+
+ protected:
+  uint32_t hash_ = 2166136261u;
+};
+
+// Last known state, kept in flash over a reboot or OTA update
+template<size_t ZONES> struct WarmState {
+  uint32_t fingerprint = 0;  // Configuration the state belongs to
+  bool synced = false;       // The radar had the configured parameters
+  uint8_t target_count = 0;
+  std::array<uint8_t, ZONES> zone_counts{};
+
+  bool operator==(const WarmState &other) const {
+    return this->fingerprint == other.fingerprint && this->synced == other.synced &&
+           this->target_count == other.target_count && this->zone_counts == other.zone_counts;
+  }
+  bool operator!=(const WarmState &other) const { return !(*this == other); }
+};
+
+// Decides when the warm state is written to flash: only if it changed, and at most once per interval, so a busy room
+// does not wear the flash out. A state saved with another fingerprint is not restored.
+template<size_t ZONES> class WarmStart {
+ public:
+  WarmState<ZONES> state;
+
+  void set_interval(uint32_t interval) { this->interval_ = interval; }
+
+  // Takes over the state saved by the previous boot if it belongs to fingerprint, false if it starts cold
+  bool restore(const WarmState<ZONES> &saved, uint32_t fingerprint) {
+    this->saved_ = saved;
+    if (saved.fingerprint != fingerprint) {
+      this->state = WarmState<ZONES>{};
+      this->state.fingerprint = fingerprint;
+      return false;
+    }
+
+    this->state = saved;
+    return true;
+  }
+
+  // True if state should be saved now, force ignores the interval, e.g. before a reboot
+  bool should_save(uint32_t now, bool force = false) const {
+    if (this->state == this->saved_) {
+      return false;
+    }
+    return force || now - this->saved_millis_ >= this->interval_;
+  }
+
+  void mark_saved(uint32_t now) {
+    this->saved_ = this->state;
+    this->saved_millis_ = now;
+  }
+
+ protected:
+  WarmState<ZONES> saved_;
+  uint32_t saved_millis_ = 0;
+  uint32_t interval_ = 0;
+};
+
+}  // namespace ld6001
+}  // namespace esphome
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace esphome {
+namespace ld6001 {
+
+static const uint8_t MAX_ZONE_VERTICES = 16;
+
+// One polygon edge, prepared for the crossing test: a point at height y in [y_lo, y_hi) lies left of the edge if
+// x < x0 + slope * y. Horizontal edges are kept with an empty range, so they never count.
+struct ZoneEdge {
+  float y_lo;
+  float y_hi;
+  float x0;
+  float slope;
+
+  static ZoneEdge create(int16_t ax, int16_t ay, int16_t bx, int16_t by) {
+    if (ay == by) {
+      return ZoneEdge{float(ay), float(ay), 0, 0};
+    }
+    float slope = float(bx - ax) / float(by - ay);
+    return ZoneEdge{float(std::min(ay, by)), float(std::max(ay, by)), ax - slope * ay, slope};
+  }
+};
+
+// Zone coordinate struct, in cm
+//
+// A zone is the rectangle (x1, y1) - (x2, y2), unless vertices were added. It is then an arbitrary, also concave,
+// polygon and the rectangle is its bounding box.
+struct Zone {
+  int16_t x1 = 0;
+  int16_t y1 = 0;
+  int16_t x2 = 0;
+  int16_t y2 = 0;
+  uint8_t target_count = 0;
+
+  bool is_polygon() const { return this->vertex_count_ > 0; }
+  uint8_t get_vertex_count() const { return this->vertex_count_; }
+
+  // Appends a vertex to the polygon, the polygon is closed from the last vertex back to the first. Only meant to be
+  // called while configuring, it keeps the edge table and bounding box up to date.
+  bool add_vertex(int16_t x, int16_t y) {
+    if (this->vertex_count_ == MAX_ZONE_VERTICES) {
+      return false;
+    }
+
+    if (this->vertex_count_ == 0) {
+      this->first_ = {x, y};
+      this->x1 = this->x2 = x;
+      this->y1 = this->y2 = y;
+    } else {
+      // Replace the closing edge of the previous vertex by the edge to this one
+      this->edges_[this->vertex_count_ - 1] = ZoneEdge::create(this->last_[0], this->last_[1], x, y);
+    }
+
+    this->edges_[this->vertex_count_] = ZoneEdge::create(x, y, this->first_[0], this->first_[1]);
+    this->last_ = {x, y};
+    this->vertex_count_++;
+
+    this->x1 = std::min(this->x1, x);
+    this->y1 = std::min(this->y1, y);
+    this->x2 = std::max(this->x2, x);
+    this->y2 = std::max(this->y2, y);
+    return true;
+  }
+
+  bool contains(const int16_t x, const int16_t y) const {
+    if (!(x >= this->x1 && x <= this->x2 && y >= this->y1 && y <= this->y2)) {
+      return false;
+    }
+    if (this->vertex_count_ == 0) {
+      return true;
+    }
+
+    // Even-odd rule: count the edges crossed by a ray from the point to the right
+    bool inside = false;
+    for (uint8_t i = 0; i < this->vertex_count_; i++) {
+      const auto &edge = this->edges_[i];
+      inside ^= (y >= edge.y_lo) & (y < edge.y_hi) & (x < edge.x0 + edge.slope * y);
+    }
+    return inside;
+  }
+
+  // Counts the targets inside the zone, target coordinates are in cm like the zone
+  template<typename Container> uint8_t count_targets(const Container &targets) const {
+    uint8_t count = 0;
+    for (const auto &target : targets) {
+      if (this->contains(target.x, target.y)) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+ protected:
+  std::array<ZoneEdge, MAX_ZONE_VERTICES> edges_{};
+  std::array<int16_t, 2> first_{};
+  std::array<int16_t, 2> last_{};
+  uint8_t vertex_count_ = 0;
+};
+
+}  // namespace ld6001
+}  // namespace esphome
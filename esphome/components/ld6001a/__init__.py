@@ -3,23 +3,140 @@ from esphome.components import uart
 import esphome.config_validation as cv
 from esphome.const import CONF_ID, CONF_THROTTLE
 from esphome import automation, pins
+from esphome.core import CORE
 
 DEPENDENCIES = ["uart"]
 MULTI_CONF = True
 
-MAX_ZONES = 4
+MAX_ZONES = 64  # ZoneEngine::CAPACITY
+MAX_NUMBER_ZONES = 4  # Zones whose rectangle can be set through number entities
+MAX_ZONE_VERTICES = 16
+MAX_HEATMAP_CELLS = 4096  # HEATMAP_MAX_CELLS
 
 ld6001a_ns = cg.esphome_ns.namespace("ld6001a")
 LD6001AComponent = ld6001a_ns.class_("LD6001AComponent", cg.Component, uart.UARTDevice)
 Person = ld6001a_ns.struct("Person")
-People_t = cg.std_vector.template(Person)
-People_t_const_ref = People_t.operator("ref").operator("const")
+People_t = ld6001a_ns.class_("Span").template(Person)
+Bytes_t = ld6001a_ns.class_("Span").template(cg.uint8)
+CommandType = ld6001a_ns.enum("CommandType", is_class=True)
 
 CONF_LD6001A_ID = "ld6001a_id"
 CONF_ON_TARGET_ENTER = "on_target_enter"
 CONF_ON_TARGET_LEFT = "on_target_left"
+CONF_ON_ZONE_ENTER = "on_zone_enter"
+CONF_ON_ZONE_LEFT = "on_zone_left"
 CONF_ON_UPDATE = "on_update"
 CONF_RESET_PIN = "reset_pin"
+CONF_PARSER_TASK = "parser_task"
+CONF_COALESCE_WINDOW = "coalesce_window"
+CONF_ON_CAPTURE = "on_capture"
+CONF_ON_SNAPSHOT = "on_snapshot"
+CONF_SMOOTHING = "smoothing"
+CONF_ALPHA = "alpha"
+CONF_BETA = "beta"
+CONF_ZONES = "zones"
+CONF_POLYGON = "polygon"
+CONF_HEATMAP = "heatmap"
+CONF_CELL_SIZE = "cell_size"
+CONF_X_MIN = "x_min"
+CONF_X_MAX = "x_max"
+CONF_Y_MIN = "y_min"
+CONF_Y_MAX = "y_max"
+CONF_DECAY_INTERVAL = "decay_interval"
+CONF_DECAY_FACTOR = "decay_factor"
+CONF_ON_EXPORT = "on_export"
+CONF_WARM_START = "warm_start"
+CONF_SAVE_INTERVAL = "save_interval"
+CONF_PARAMETERS = "parameters"
+CONF_GROUND_RADIUS = "ground_radius"
+CONF_INSTALLATION_HEIGHT = "installation_height"
+CONF_LONG_DISTANCE_SENSITIVITY = "long_distance_sensitivity"
+CONF_HEARTBEAT = "heart_beat"
+CONF_TARGET_EXIT_BOUNDARY_TIME = "target_exit_boundary_time"
+CONF_STATIC_TARGET_DISAPPEARANCE_TIME = "static_target_disappearance_time"
+CONF_MOVING_TARGET_DISAPPEARANCE_TIME = "moving_target_disappearance_time"
+
+# A vertex is written as [x, y] in cm
+ZONE_VERTEX_SCHEMA = cv.All(cv.ensure_list(cv.int_range(min=-32768, max=32767)), cv.Length(min=2, max=2))
+ZONE_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_POLYGON): cv.All(
+            cv.ensure_list(ZONE_VERTEX_SCHEMA), cv.Length(min=3, max=MAX_ZONE_VERTICES)
+        ),
+    }
+)
+
+
+def validate_heatmap(config):
+    if config[CONF_X_MAX] <= config[CONF_X_MIN] or config[CONF_Y_MAX] <= config[CONF_Y_MIN]:
+        raise cv.Invalid(f"{CONF_X_MAX} and {CONF_Y_MAX} must be larger than {CONF_X_MIN} and {CONF_Y_MIN}")
+    cell_size = config[CONF_CELL_SIZE]
+    columns = -(-(config[CONF_X_MAX] - config[CONF_X_MIN]) // cell_size)
+    rows = -(-(config[CONF_Y_MAX] - config[CONF_Y_MIN]) // cell_size)
+    if columns * rows > MAX_HEATMAP_CELLS:
+        raise cv.Invalid(
+            f"Heatmap of {columns}x{rows} cells exceeds {MAX_HEATMAP_CELLS} cells, increase {CONF_CELL_SIZE}"
+        )
+    return config
+
+
+# Area and cell size in cm
+HEATMAP_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_CELL_SIZE, default=25): cv.int_range(min=1, max=1000),
+            cv.Optional(CONF_X_MIN, default=-400): cv.int_range(min=-32768, max=32767),
+            cv.Optional(CONF_X_MAX, default=400): cv.int_range(min=-32768, max=32767),
+            cv.Optional(CONF_Y_MIN, default=-400): cv.int_range(min=-32768, max=32767),
+            cv.Optional(CONF_Y_MAX, default=400): cv.int_range(min=-32768, max=32767),
+            cv.Optional(CONF_DECAY_INTERVAL, default="10min"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_DECAY_FACTOR, default=0.9): cv.float_range(min=0, max=1),
+            cv.Optional(CONF_ON_EXPORT): automation.validate_automation(single=True),
+        }
+    ),
+    validate_heatmap,
+)
+
+
+def validate_tenths_of_second(value):
+    if value.total_milliseconds % 100 != 0:
+        raise cv.Invalid("Must be a multiple of 100ms")
+    return value
+
+
+def radar_time(min_ms):
+    return cv.All(
+        cv.positive_time_period_milliseconds,
+        cv.Range(min=cv.TimePeriod(milliseconds=min_ms), max=cv.TimePeriod(seconds=100)),
+        validate_tenths_of_second,
+    )
+
+
+# Parameters written to the radar on boot if it has different ones, ranges as in the Command factories
+PARAMETERS = {
+    CONF_GROUND_RADIUS: (CommandType.RANGE, cv.int_range(min=100, max=500)),
+    CONF_INSTALLATION_HEIGHT: (CommandType.INSTALLATION_HEIGHT, cv.int_range(min=50, max=500)),
+    CONF_LONG_DISTANCE_SENSITIVITY: (CommandType.RANGE_SENSITIVITY, cv.int_range(min=1, max=9)),
+    CONF_HEARTBEAT: (CommandType.HEARTBEAT_INTERVAL, cv.int_range(min=10, max=999)),
+    CONF_TARGET_EXIT_BOUNDARY_TIME: (CommandType.EXIT_BOUNDARY_TIME, radar_time(200)),
+    CONF_STATIC_TARGET_DISAPPEARANCE_TIME: (CommandType.STATIC_TARGET_DISAPPEARANCE_TIME, radar_time(500)),
+    CONF_MOVING_TARGET_DISAPPEARANCE_TIME: (CommandType.MOVING_TARGET_DISAPPEARANCE_TIME, radar_time(500)),
+    CONF_X_MIN: (CommandType.X_MIN, cv.int_range(min=-500, max=-20)),
+    CONF_X_MAX: (CommandType.X_MAX, cv.int_range(min=20, max=500)),
+    CONF_Y_MIN: (CommandType.Y_MIN, cv.int_range(min=-500, max=-20)),
+    CONF_Y_MAX: (CommandType.Y_MAX, cv.int_range(min=20, max=500)),
+}
+
+PARAMETERS_SCHEMA = cv.Schema({cv.Optional(key): validator for key, (_, validator) in PARAMETERS.items()})
+
+
+def validate_parser_task(config):
+    if config[CONF_PARSER_TASK] and not CORE.is_esp32:
+        raise cv.Invalid(f"{CONF_PARSER_TASK} is only supported on ESP32")
+    if config[CONF_PARSER_TASK] and CONF_ON_CAPTURE in config:
+        raise cv.Invalid(f"{CONF_ON_CAPTURE} cannot be combined with {CONF_PARSER_TASK}")
+    return config
+
 
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
@@ -30,14 +147,35 @@ CONFIG_SCHEMA = cv.All(
                 cv.Range(min=cv.TimePeriod(milliseconds=1)),
             ),
             cv.Optional(CONF_RESET_PIN): pins.internal_gpio_output_pin_schema,
+            cv.Optional(CONF_COALESCE_WINDOW): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_PARSER_TASK, default=False): cv.boolean,
+            cv.Optional(CONF_ZONES): cv.All(cv.ensure_list(ZONE_SCHEMA), cv.Length(max=MAX_ZONES)),
+            cv.Optional(CONF_HEATMAP): HEATMAP_SCHEMA,
+            cv.Optional(CONF_WARM_START): cv.Schema(
+                {
+                    cv.Optional(CONF_SAVE_INTERVAL, default="5min"): cv.positive_time_period_milliseconds,
+                }
+            ),
+            cv.Optional(CONF_PARAMETERS): PARAMETERS_SCHEMA,
+            cv.Optional(CONF_SMOOTHING): cv.Schema(
+                {
+                    cv.Optional(CONF_ALPHA, default=0.3): cv.float_range(min=0, min_included=False, max=1),
+                    cv.Optional(CONF_BETA, default=0.5): cv.float_range(min=0, max=1),
+                }
+            ),
 
             cv.Optional(CONF_ON_TARGET_ENTER): automation.validate_automation(single=True),
             cv.Optional(CONF_ON_TARGET_LEFT): automation.validate_automation(single=True),
+            cv.Optional(CONF_ON_ZONE_ENTER): automation.validate_automation(single=True),
+            cv.Optional(CONF_ON_ZONE_LEFT): automation.validate_automation(single=True),
             cv.Optional(CONF_ON_UPDATE): automation.validate_automation(single=True),
+            cv.Optional(CONF_ON_CAPTURE): automation.validate_automation(single=True),
+            cv.Optional(CONF_ON_SNAPSHOT): automation.validate_automation(single=True),
 
         }
     )
-    .extend(uart.UART_DEVICE_SCHEMA)
+    .extend(uart.UART_DEVICE_SCHEMA),
+    validate_parser_task,
 )
 
 LD6001ABaseSchema = cv.Schema(
@@ -57,6 +195,48 @@ async def to_code(config):
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
     cg.add(var.set_throttle(config[CONF_THROTTLE]))
+    if CONF_COALESCE_WINDOW in config:
+        cg.add(var.set_coalesce_window(config[CONF_COALESCE_WINDOW]))
+
+    if config[CONF_PARSER_TASK]:
+        cg.add_define("USE_LD6001A_PARSER_TASK")
+        cg.add(var.set_parser_task(True))
+
+    for n, zone_config in enumerate(config.get(CONF_ZONES, [])):
+        vertices = ", ".join(f"{{{x}, {y}}}" for x, y in zone_config[CONF_POLYGON])
+        cg.add(var.set_zone_polygon(n, cg.RawExpression(f"{{{vertices}}}")))
+
+    for key, value in config.get(CONF_PARAMETERS, {}).items():
+        if isinstance(value, cv.TimePeriod):
+            value = value.total_milliseconds
+        cg.add(var.set_parameter(PARAMETERS[key][0], value))
+
+    if smoothing_config := config.get(CONF_SMOOTHING):
+        cg.add(var.set_smoothing(smoothing_config[CONF_ALPHA], smoothing_config[CONF_BETA]))
+
+    if warm_start_config := config.get(CONF_WARM_START):
+        cg.add_define("USE_LD6001A_WARM_START")
+        cg.add(var.set_warm_start(warm_start_config[CONF_SAVE_INTERVAL]))
+
+    if heatmap_config := config.get(CONF_HEATMAP):
+        cg.add_define("USE_LD6001A_HEATMAP")
+        cg.add(
+            var.set_heatmap(
+                heatmap_config[CONF_X_MIN],
+                heatmap_config[CONF_Y_MIN],
+                heatmap_config[CONF_X_MAX],
+                heatmap_config[CONF_Y_MAX],
+                heatmap_config[CONF_CELL_SIZE],
+                heatmap_config[CONF_DECAY_INTERVAL],
+                heatmap_config[CONF_DECAY_FACTOR],
+            )
+        )
+        if CONF_ON_EXPORT in heatmap_config:
+            await automation.build_automation(
+                var.get_heatmap_trigger(),
+                [(cg.std_vector.template(cg.uint8), "data")],
+                heatmap_config[CONF_ON_EXPORT],
+            )
 
     if CONF_ON_TARGET_ENTER in config:
         await automation.build_automation(
@@ -72,13 +252,43 @@ async def to_code(config):
             config[CONF_ON_TARGET_LEFT],
         )
 
+    if CONF_ON_ZONE_ENTER in config:
+        await automation.build_automation(
+            var.get_zone_enter_trigger(),
+            [(cg.uint8, "zone"), (cg.uint32, "target_id")],
+            config[CONF_ON_ZONE_ENTER],
+        )
+
+    if CONF_ON_ZONE_LEFT in config:
+        await automation.build_automation(
+            var.get_zone_left_trigger(),
+            [(cg.uint8, "zone"), (cg.uint32, "target_id"), (cg.uint32, "dwell_time")],
+            config[CONF_ON_ZONE_LEFT],
+        )
+
     if CONF_ON_UPDATE in config:
         await automation.build_automation(
             var.get_update_trigger(),
-            [(People_t_const_ref, "targets")],
+            [(People_t, "targets")],
             config[CONF_ON_UPDATE],
         )
 
+    if CONF_ON_CAPTURE in config:
+        cg.add_define("USE_LD6001A_CAPTURE")
+        await automation.build_automation(
+            var.get_capture_trigger(),
+            [(cg.std_vector.template(cg.uint8), "data")],
+            config[CONF_ON_CAPTURE],
+        )
+
+    if CONF_ON_SNAPSHOT in config:
+        cg.add_define("USE_LD6001A_SNAPSHOT")
+        await automation.build_automation(
+            var.get_snapshot_trigger(),
+            [(Bytes_t, "data")],
+            config[CONF_ON_SNAPSHOT],
+        )
+
     if CONF_RESET_PIN in config:
         reset_pin = await cg.gpio_pin_expression(config[CONF_RESET_PIN])
         print(f"Reset pin: {reset_pin}")
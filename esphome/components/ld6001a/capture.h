@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+namespace esphome {
+namespace ld6001a {
+
+// Compact binary log of the raw UART bytes, to reproduce field problems with the native replay test.
+//
+// A capture starts with the magic "LDCAP" and a version byte, followed by one record per UART read:
+//
+//   varint  milliseconds since the previous record
+//   varint  number of data bytes
+//   bytes   raw UART data
+//
+// Varints are little endian base 128 as in protobuf. Since timestamps are relative, the flushed pieces of a capture
+// can simply be concatenated again.
+static const uint8_t CAPTURE_MAGIC[] = {'L', 'D', 'C', 'A', 'P'};
+static const uint8_t CAPTURE_VERSION = 1;
+static const size_t CAPTURE_HEADER_SIZE = sizeof(CAPTURE_MAGIC) + 1;
+static const size_t CAPTURE_MAX_VARINT_SIZE = 5;
+
+template<size_t N> class CaptureRecorder {
+  static_assert(N > CAPTURE_HEADER_SIZE + 2 * CAPTURE_MAX_VARINT_SIZE, "Capture buffer is too small");
+
+ public:
+  using flush_callback_t = std::function<void(const uint8_t *data, size_t len)>;
+
+  explicit CaptureRecorder(flush_callback_t on_flush) : on_flush_(std::move(on_flush)) {}
+
+  // Appends a record, handing full buffers to the flush callback. Reads larger than the buffer are split up.
+  void record(uint32_t now, const uint8_t *data, size_t len) {
+    if (!this->started_) {
+      std::memcpy(this->buffer_.data(), CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+      this->buffer_[sizeof(CAPTURE_MAGIC)] = CAPTURE_VERSION;
+      this->size_ = CAPTURE_HEADER_SIZE;
+      this->last_time_ = now;
+      this->started_ = true;
+    }
+
+    while (len > 0) {
+      if (N - this->size_ <= 2 * CAPTURE_MAX_VARINT_SIZE) {
+        this->flush();
+      }
+
+      size_t count = std::min(len, N - this->size_ - 2 * CAPTURE_MAX_VARINT_SIZE);
+      this->put_varint_(now - this->last_time_);
+      this->put_varint_(count);
+      std::memcpy(this->buffer_.data() + this->size_, data, count);
+      this->size_ += count;
+
+      this->last_time_ = now;
+      this->bytes_recorded_ += count;
+      data += count;
+      len -= count;
+    }
+  }
+
+  void flush() {
+    if (this->size_ > 0) {
+      this->on_flush_(this->buffer_.data(), this->size_);
+      this->size_ = 0;
+    }
+  }
+
+  size_t size() const { return this->size_; }
+  uint32_t get_bytes_recorded() const { return this->bytes_recorded_; }
+
+ protected:
+  void put_varint_(uint32_t value) {
+    while (value >= 0x80) {
+      this->buffer_[this->size_++] = static_cast<uint8_t>(value) | 0x80;
+      value >>= 7;
+    }
+    this->buffer_[this->size_++] = static_cast<uint8_t>(value);
+  }
+
+  flush_callback_t on_flush_;
+  std::array<uint8_t, N> buffer_{};
+  size_t size_ = 0;
+  uint32_t last_time_ = 0;
+  uint32_t bytes_recorded_ = 0;
+  bool started_ = false;
+};
+
+struct CaptureRecord {
+  uint32_t time;  // Milliseconds since the start of the capture
+  const uint8_t *data;
+  size_t length;
+};
+
+// Walks the records of a capture held in memory.
+class CaptureReader {
+ public:
+  CaptureReader(const uint8_t *data, size_t len) : data_(data), end_(data + len) {
+    this->valid_ = len >= CAPTURE_HEADER_SIZE && std::memcmp(data, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0 &&
+                   data[sizeof(CAPTURE_MAGIC)] == CAPTURE_VERSION;
+    this->data_ += this->valid_ ? CAPTURE_HEADER_SIZE : len;
+  }
+
+  bool valid() const { return this->valid_; }
+
+  // Set when the capture ends in the middle of a record, e.g. because the device rebooted before flushing.
+  bool truncated() const { return this->truncated_; }
+
+  bool next(CaptureRecord &record) {
+    if (this->data_ == this->end_) {
+      return false;
+    }
+
+    uint32_t delta, length;
+    if (!this->get_varint_(delta) || !this->get_varint_(length) || length > size_t(this->end_ - this->data_)) {
+      this->truncated_ = true;
+      this->data_ = this->end_;
+      return false;
+    }
+
+    this->time_ += delta;
+    record = CaptureRecord{this->time_, this->data_, length};
+    this->data_ += length;
+    return true;
+  }
+
+ protected:
+  bool get_varint_(uint32_t &value) {
+    value = 0;
+    for (size_t i = 0; i < CAPTURE_MAX_VARINT_SIZE && this->data_ != this->end_; i++) {
+      uint8_t byte = *this->data_++;
+      value |= uint32_t(byte & 0x7F) << (7 * i);
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const uint8_t *data_;
+  const uint8_t *end_;
+  uint32_t time_ = 0;
+  bool valid_ = false;
+  bool truncated_ = false;
+};
+
+}  // namespace ld6001a
+}  // namespace esphome
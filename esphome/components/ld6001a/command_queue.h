@@ -1,8 +1,14 @@
 #pragma once
 
-#include <queue>
-#include <string>
-#include <functional>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "esphome/core/log.h"
 
 namespace esphome::ld6001a {
 enum ProtocolMode {
@@ -11,152 +17,419 @@ enum ProtocolMode {
   PROTOCOL_MODE_DEBUG = 2,
   PROTOCOL_MODE_DETAILED = 3,
 };
+
+static const size_t MAX_COMMAND_LENGTH = 24;   // Longest command is "AT+HEATIME=999\n"
+static const size_t COMMAND_QUEUE_SIZE = 16;   // Commands waiting to be sent, enough for a full configuration
+static const uint16_t COMMAND_TIMEOUT = 1000;         // ms to wait for the first reply, doubled with every retry
+static const uint16_t RESET_COMMAND_TIMEOUT = 5000;   // The radar reboots before it replies
+static const uint32_t MAX_COMMAND_TIMEOUT = 16000;    // Backoff limit
+static const uint8_t COMMAND_RETRIES = 3;             // Sends after the first one before a command is dropped
+
+enum class CommandType : uint8_t {
+  READ,
+  START,
+  STOP,
+  RESET,
+  RESTORE,
+  PROTOCOL_MODE,
+  // Parameter writes from here on, see Command::is_write()
+  RANGE,
+  EXIT_BOUNDARY_TIME,
+  HEARTBEAT_INTERVAL,
+  INSTALLATION_HEIGHT,
+  RANGE_SENSITIVITY,
+  X_MIN,
+  X_MAX,
+  Y_MIN,
+  Y_MAX,
+  MOVING_TARGET_DISAPPEARANCE_TIME,
+  STATIC_TARGET_DISAPPEARANCE_TIME,
+};
+
+// AT command formatted into a fixed buffer. The value it was built from is kept for the completion callback, in the
+// units of the config_*() call.
 class Command {
  public:
-  std::string data;
-  std::function<void(const std::string &)> onResponse;
+  CommandType type = CommandType::READ;
+  int32_t value = 0;
+  std::array<char, MAX_COMMAND_LENGTH> data{};
+  uint8_t length = 0;
+  uint16_t timeout = COMMAND_TIMEOUT;
+  uint8_t max_retries = COMMAND_RETRIES;
+
+  Command() = default;
+
+  const char *c_str() const { return this->data.data(); }
+
+  Command with_timeout(uint16_t timeout) const {
+    Command command = *this;
+    command.timeout = timeout;
+    return command;
+  }
+
+  Command with_retries(uint8_t max_retries) const {
+    Command command = *this;
+    command.max_retries = max_retries;
+    return command;
+  }
+
+  // ms to wait for the reply after the given send, 0 being the first one
+  uint32_t get_timeout(uint8_t attempt) const {
+    return std::min<uint32_t>(uint32_t(this->timeout) << std::min<uint8_t>(attempt, 16), MAX_COMMAND_TIMEOUT);
+  }
 
-  Command(const std::string &cmd, std::function<void(const std::string &)> cb = nullptr) : data(cmd), onResponse(cb) {}
+  // Parameter writes only matter with their latest value, so the queue merges them per type
+  bool is_write() const { return this->type >= CommandType::RANGE; }
 
-  static Command ReadCommand(std::function<void(const std::string &)> cb = nullptr) { return Command("AT+READ\n", cb); }
+  // Commands with a value, and AT+READ with its parameter dump, are answered by their echo only. Only the others may
+  // be answered by a bare "OK", which does not tell which command it answers.
+  bool accepts_ok() const {
+    return this->type != CommandType::READ && std::strchr(this->data.data(), '=') == nullptr;
+  }
 
-  static Command StartCommand(std::function<void(const std::string &)> cb = nullptr) {
-    return Command("AT+START\n", cb);
+  // True if reply, the text of an AT reply after "AT+", answers this command: the echo of the command name, e.g.
+  // "RANGE=300" for "AT+RANGE=300\n", or "OK" if accepts_ok().
+  bool matches_reply(const char *reply) const {
+    if (std::strcmp(reply, "OK") == 0) {
+      return this->accepts_ok();
+    }
+
+    const char *name = this->data.data() + 3;  // Skip "AT+"
+    for (; *name != '=' && *name != '\n' && *name != '\0'; name++, reply++) {
+      if (std::toupper(*name) != std::toupper(*reply)) {
+        return false;
+      }
+    }
+    return *reply == '=' || *reply == '\0';
   }
 
-  static Command StopCommand(std::function<void(const std::string &)> cb = nullptr) { return Command("AT+STOP\n", cb); }
+  static Command ReadCommand() { return Command(CommandType::READ, 0, "AT+READ\n"); }
 
-  static Command ResetCommand(std::function<void(const std::string &)> cb = nullptr) {
-    return Command("AT+RESET\n", cb);
+  static Command StartCommand() { return Command(CommandType::START, 0, "AT+START\n"); }
+
+  static Command StopCommand() { return Command(CommandType::STOP, 0, "AT+STOP\n"); }
+
+  static Command ResetCommand() {
+    return Command(CommandType::RESET, 0, "AT+RESET\n").with_timeout(RESET_COMMAND_TIMEOUT);
   }
 
-  static Command RestoreCommand(std::function<void(const std::string &)> cb = nullptr) {
-    return Command("AT+RESTORE\n", cb);
+  static Command RestoreCommand() {
+    return Command(CommandType::RESTORE, 0, "AT+RESTORE\n").with_timeout(RESET_COMMAND_TIMEOUT);
   }
 
-  static Command RangeCommand(uint16_t radius_cm, std::function<void(const std::string &)> cb = nullptr) {
+  static Command RangeCommand(uint16_t radius_cm) {
     assert(radius_cm >= 100 && radius_cm <= 500);
 
-    return Command(str_sprintf("AT+RANGE=%d\n", radius_cm).c_str(), cb);
+    return Command(CommandType::RANGE, radius_cm, "AT+RANGE=%d\n", radius_cm);
   }
 
-  static Command TargetExitBoundaryTimeCommand(uint32_t time_ms,
-                                               std::function<void(const std::string &)> cb = nullptr) {
+  static Command TargetExitBoundaryTimeCommand(uint32_t time_ms) {
     assert(time_ms % 100 == 0);
     assert(time_ms >= 200 && time_ms <= 1000 * 100);
 
-    return Command(str_sprintf("AT+Exit=%d\n", time_ms / 100).c_str(), cb);
+    return Command(CommandType::EXIT_BOUNDARY_TIME, time_ms, "AT+Exit=%d\n", time_ms / 100);
   }
 
-  static Command HeartBeatIntervalCommand(uint16_t interval_s, std::function<void(const std::string &)> cb = nullptr) {
+  static Command HeartBeatIntervalCommand(uint16_t interval_s) {
     assert(interval_s >= 10 && interval_s <= 999);
 
-    return Command(str_sprintf("AT+HEATIME=%d\n", interval_s).c_str(), cb);
+    return Command(CommandType::HEARTBEAT_INTERVAL, interval_s, "AT+HEATIME=%d\n", interval_s);
   }
 
-  static Command InstallationHeightCommand(uint16_t height_cm, std::function<void(const std::string &)> cb = nullptr) {
+  static Command InstallationHeightCommand(uint16_t height_cm) {
     assert(height_cm >= 50 && height_cm <= 500);
-    return Command(str_sprintf("AT+HEIGHTD=%d\n", height_cm).c_str(), cb);
+    return Command(CommandType::INSTALLATION_HEIGHT, height_cm, "AT+HEIGHTD=%d\n", height_cm);
   }
 
-  static Command RangeSensitivityCommand(uint16_t sensitivity, std::function<void(const std::string &)> cb = nullptr) {
+  static Command RangeSensitivityCommand(uint16_t sensitivity) {
     assert(sensitivity >= 1 && sensitivity <= 9);
-    return Command(str_sprintf("AT+DPKTH=%d\n", sensitivity).c_str(), cb);
+    return Command(CommandType::RANGE_SENSITIVITY, sensitivity, "AT+DPKTH=%d\n", sensitivity);
   }
 
-  static Command XMinCommand(int x_min, std::function<void(const std::string &)> cb = nullptr) {
+  static Command XMinCommand(int x_min) {
     assert(x_min >= -500 && x_min <= -20);
-    return Command(str_sprintf("AT+XNega=%d\n", x_min).c_str(), cb);
+    return Command(CommandType::X_MIN, x_min, "AT+XNega=%d\n", x_min);
   }
 
-  static Command XMaxCommand(int x_max, std::function<void(const std::string &)> cb = nullptr) {
+  static Command XMaxCommand(int x_max) {
     assert(x_max >= 20 && x_max <= 500);
-    return Command(str_sprintf("AT+XPosi=%d\n", x_max).c_str(), cb);
+    return Command(CommandType::X_MAX, x_max, "AT+XPosi=%d\n", x_max);
   }
 
-  static Command YMinCommand(int y_min, std::function<void(const std::string &)> cb = nullptr) {
+  static Command YMinCommand(int y_min) {
     assert(y_min >= -500 && y_min <= -20);
-    return Command(str_sprintf("AT+YNega=%d\n", y_min).c_str(), cb);
+    return Command(CommandType::Y_MIN, y_min, "AT+YNega=%d\n", y_min);
   }
 
-  static Command YMaxCommand(int y_max, std::function<void(const std::string &)> cb = nullptr) {
+  static Command YMaxCommand(int y_max) {
     assert(y_max >= 20 && y_max <= 500);
-    return Command(str_sprintf("AT+YPosi=%d\n", y_max).c_str(), cb);
+    return Command(CommandType::Y_MAX, y_max, "AT+YPosi=%d\n", y_max);
   }
 
-  static Command SetProtocolModeCommand(ProtocolMode mode, std::function<void(const std::string &)> cb = nullptr) {
-    return Command(str_sprintf("AT+DEBUG=%d\n", mode).c_str(), cb);
+  static Command SetProtocolModeCommand(ProtocolMode mode) {
+    return Command(CommandType::PROTOCOL_MODE, mode, "AT+DEBUG=%d\n", mode);
   }
 
-  static Command SetMovingTargetDisappearanceTimeCommand(uint32_t time_ms,
-                                                         std::function<void(const std::string &)> cb = nullptr) {
+  static Command SetMovingTargetDisappearanceTimeCommand(uint32_t time_ms) {
     assert(time_ms % 100 == 0);
     assert(time_ms >= 500 && time_ms <= 1000 * 100);
 
-    return Command(str_sprintf("AT+Moving=%d\n", time_ms / 100).c_str(), cb);
+    return Command(CommandType::MOVING_TARGET_DISAPPEARANCE_TIME, time_ms, "AT+Moving=%d\n", time_ms / 100);
   }
-  static Command SetStaticTargetDisappearanceTimeCommand(uint32_t time_ms,
-                                                         std::function<void(const std::string &)> cb = nullptr) {
+  static Command SetStaticTargetDisappearanceTimeCommand(uint32_t time_ms) {
     assert(time_ms % 100 == 0);
     assert(time_ms >= 500 && time_ms <= 1000 * 100);
 
-    return Command(str_sprintf("AT+Static=%d\n", time_ms / 100).c_str(), cb);
+    return Command(CommandType::STATIC_TARGET_DISAPPEARANCE_TIME, time_ms, "AT+Static=%d\n", time_ms / 100);
+  }
+
+  // Parameter write of the given type, value in the units of its factory above
+  static Command WriteCommand(CommandType type, int32_t value) {
+    switch (type) {
+      case CommandType::RANGE:
+        return RangeCommand(value);
+      case CommandType::EXIT_BOUNDARY_TIME:
+        return TargetExitBoundaryTimeCommand(value);
+      case CommandType::HEARTBEAT_INTERVAL:
+        return HeartBeatIntervalCommand(value);
+      case CommandType::INSTALLATION_HEIGHT:
+        return InstallationHeightCommand(value);
+      case CommandType::RANGE_SENSITIVITY:
+        return RangeSensitivityCommand(value);
+      case CommandType::X_MIN:
+        return XMinCommand(value);
+      case CommandType::X_MAX:
+        return XMaxCommand(value);
+      case CommandType::Y_MIN:
+        return YMinCommand(value);
+      case CommandType::Y_MAX:
+        return YMaxCommand(value);
+      case CommandType::MOVING_TARGET_DISAPPEARANCE_TIME:
+        return SetMovingTargetDisappearanceTimeCommand(value);
+      case CommandType::STATIC_TARGET_DISAPPEARANCE_TIME:
+        return SetStaticTargetDisappearanceTimeCommand(value);
+      default:
+        assert(false);
+        return ReadCommand();
+    }
   }
+
+ protected:
+  Command(CommandType type, int32_t value, const char *format, int arg = 0) : type(type), value(value) {
+    int length = snprintf(this->data.data(), this->data.size(), format, arg);
+    this->length = std::min<int>(length, this->data.size() - 1);
+  }
+};
+
+static const size_t WRITE_COMMAND_TYPES =
+    size_t(CommandType::STATIC_TARGET_DISAPPEARANCE_TIME) - size_t(CommandType::RANGE) + 1;
+
+struct CommandStats {
+  uint32_t sent = 0;      // Sends including retries
+  uint32_t retries = 0;   // Sends after a timeout
+  uint32_t failures = 0;  // Commands dropped after their last retry
 };
 
+class CommandHandler {
+ public:
+  virtual void send_command(const Command &command) = 0;
+  virtual void on_command_done(const Command &command) {}
+  virtual void on_command_failed(const Command &command) {}
+};
+
+// Sends commands one at a time, the next one only after the radar replied to the previous one.
+//
+// Parameter writes are kept apart from the other commands, in one slot per type: a write replaces a pending write of
+// the same type, so dragging a slider sends only its last value. Pending writes are sent as one batch, bracketed by
+// AT+STOP and AT+START while the radar runs, and followed by a single AT+READ. Other commands are sent in order, before
+// a batch is started.
+//
+// Commands are copied into fixed storage, nothing is allocated. Nothing blocks either: replies are handed in through
+// handle_reply() as they are parsed, and loop() checks the time since the last send. A command without reply is sent
+// again after its timeout, which doubles with every retry. After max_retries it is dropped and reported as failed, so
+// a wedged radar does not hold up later commands.
 class CommandQueue {
  public:
-  CommandQueue(std::function<void(const std::string &)> sender) : sendFunction(sender) {};
+  CommandQueue(CommandHandler &handler) : handler_(handler) {}
+
+  // Queues the command and sends it right away if no other command waits for its reply. Fails if the queue is full.
+  bool enqueue(const Command &command, uint32_t now) {
+    if (command.is_write()) {
+      size_t slot = size_t(command.type) - size_t(CommandType::RANGE);
+      if (this->pending_writes_ & (1u << slot)) {
+        ESP_LOGV("ld6001a", "Replacing pending %s", this->writes_[slot].c_str());
+      }
+      this->writes_[slot] = command;
+      this->pending_writes_ |= 1u << slot;
+    } else {
+      if (this->size_ == COMMAND_QUEUE_SIZE) {
+        ESP_LOGE("ld6001a", "Command queue full, dropping %s", command.c_str());
+        return false;
+      }
+
+      this->commands_[(this->head_ + this->size_) % COMMAND_QUEUE_SIZE] = command;
+      this->size_++;
+    }
 
-  void enqueue(const Command &cmd) {
-    queue.push(cmd);
-    trySendNext();
+    this->try_send_next_(now);
+    return true;
   }
 
-  void send(const Command &cmd) {
-    if (sendFunction) {
-      sendFunction(cmd.data);
+  // Sends a command right away, outside of the queue and without waiting for its reply
+  void send(const Command &command) { this->handler_.send_command(command); }
+
+  void loop(uint32_t now) { this->try_send_next_(now); }
+
+  // Completes the command waiting for its reply if reply answers it. Replies that belong to no command, like the late
+  // echo of an earlier command, are ignored so they cannot complete the wrong one.
+  //
+  // A bare "OK" carries no name. The radar sends one after every echo, e.g. "AT+RANGE=300" and then "AT+OK", so after
+  // a command completed on its echo the next "OK" belongs to it and is ignored. After a send timed out, the first "OK"
+  // may be its late reply, so it is ignored too. If that was the reply to the resend after all, the command times out
+  // once more and the next "OK" is taken.
+  bool handle_reply(const char *reply, uint32_t now) {
+    bool ok = std::strcmp(reply, "OK") == 0;
+    if (ok && this->stale_ok_) {
+      this->stale_ok_ = false;
+      if (this->waiting_) {
+        ESP_LOGD("ld6001a", "Ignoring AT+OK while waiting for %s, it answers an earlier send", this->current_.c_str());
+        this->ok_ignored_ = true;
+      }
+      return false;
     }
-  }
 
-  void loop() {
-    trySendNext();
-  }
+    if (!this->waiting_) {
+      return false;
+    }
 
-  void handleResponse(const std::string &response) {
-    if (!waitingForAck || queue.empty())
-      return;
+    if (!this->current_.matches_reply(reply)) {
+      ESP_LOGD("ld6001a", "Ignoring reply AT+%s while waiting for %s", reply, this->current_.c_str());
+      return false;
+    }
 
-    Command &cmd = queue.front();
-    if (cmd.onResponse) {
-      cmd.onResponse(response);
+    this->waiting_ = false;
+    this->stale_ok_ = !ok;  // The "OK" after the echo is still to come
+    if (this->current_.type == CommandType::START || this->current_.type == CommandType::STOP) {
+      this->running_ = this->current_.type == CommandType::START;
     }
 
-    queue.pop();
-    waitingForAck = 0;
-    trySendNext();
+    // The handler may queue follow-up commands
+    this->handler_.on_command_done(this->current_);
+    this->try_send_next_(now);
+    return true;
   }
 
- private:
-  std::queue<Command> queue;
-  std::function<void(const std::string &)> sendFunction;
-  uint32_t waitingForAck = 0;
-
-  void trySendNext() {
-    auto currentMillis = millis();
+  // Commands not sent yet, pending writes included
+  size_t size() const { return this->size_ + __builtin_popcount(this->pending_writes_); }
+  const CommandStats &get_stats() const { return this->stats_; }
+  bool is_waiting() const { return this->waiting_; }
+  bool is_running() const { return this->running_; }
+
+ protected:
+  enum class BatchState : uint8_t {
+    NONE,
+    WRITING,  // Sending the pending writes, after AT+STOP if the radar was running
+    READING,  // Writes done and the radar started again, AT+READ is next
+  };
+
+  void try_send_next_(uint32_t now) {
+    if (this->waiting_ && now - this->sent_millis_ >= this->current_.get_timeout(this->attempt_)) {
+      // A late reply may still come and end in "OK", unless the "OK" ignored since the send was it
+      if (!this->ok_ignored_) {
+        this->stale_ok_ = true;
+      }
+
+      if (this->attempt_ < this->current_.max_retries) {
+        ESP_LOGW("ld6001a", "No reply to %s, sending it again", this->current_.c_str());
+        this->attempt_++;
+        this->stats_.retries++;
+        this->send_current_(now);
+        return;
+      }
+
+      ESP_LOGE("ld6001a", "No reply to %s after %u retries, dropping it", this->current_.c_str(), this->attempt_);
+      this->waiting_ = false;
+      this->stats_.failures++;
+      this->handler_.on_command_failed(this->current_);
+    }
 
-    // Timeout command after 1 second if no ack is received
-    if (waitingForAck != 0 && waitingForAck + 5000 < currentMillis) {
-      waitingForAck = 0;
-      ESP_LOGE("ld6001a", "Previous command timed out.");
+    if (!this->waiting_ && this->next_()) {
+      this->attempt_ = 0;
+      this->send_current_(now);
     }
+  }
 
-    if (!waitingForAck && !queue.empty() && sendFunction) {
-      const Command &cmd = queue.front();
-      sendFunction(cmd.data);
-      waitingForAck = currentMillis;
+  // Picks the command to send next into current_, false if there is none
+  bool next_() {
+    switch (this->batch_) {
+      case BatchState::NONE:
+        if (this->size_ > 0) {
+          this->current_ = this->commands_[this->head_];
+          this->head_ = (this->head_ + 1) % COMMAND_QUEUE_SIZE;
+          this->size_--;
+          return true;
+        }
+        if (this->pending_writes_ == 0) {
+          return false;
+        }
+
+        this->batch_ = BatchState::WRITING;
+        this->restart_ = this->running_;
+        if (this->restart_) {
+          this->current_ = Command::StopCommand();
+          return true;
+        }
+        return this->next_();
+
+      case BatchState::WRITING:
+        if (this->pending_writes_ != 0) {
+          size_t slot = __builtin_ctz(this->pending_writes_);
+          this->pending_writes_ &= ~(1u << slot);
+          this->current_ = this->writes_[slot];
+          return true;
+        }
+
+        this->batch_ = BatchState::READING;
+        if (this->restart_) {
+          this->current_ = Command::StartCommand();
+          return true;
+        }
+        return this->next_();
+
+      case BatchState::READING:
+        this->batch_ = BatchState::NONE;
+        this->current_ = Command::ReadCommand();
+        return true;
     }
+    return false;
+  }
+
+  void send_current_(uint32_t now) {
+    this->handler_.send_command(this->current_);
+    this->stats_.sent++;
+    this->waiting_ = true;
+    this->ok_ignored_ = false;
+    this->sent_millis_ = now;
   }
+
+  CommandHandler &handler_;
+  std::array<Command, COMMAND_QUEUE_SIZE> commands_{};
+  size_t head_ = 0;
+  size_t size_ = 0;
+
+  std::array<Command, WRITE_COMMAND_TYPES> writes_{};
+  uint32_t pending_writes_ = 0;  // Bit per slot of writes_
+  BatchState batch_ = BatchState::NONE;
+  bool restart_ = false;  // The batch stopped the radar and starts it again
+
+  Command current_;  // Sent, or about to be sent
+  bool waiting_ = false;
+  uint32_t sent_millis_ = 0;
+  uint8_t attempt_ = 0;      // Retries of current_ so far
+  bool stale_ok_ = false;    // An "OK" is due that answers no waiting command
+  bool ok_ignored_ = false;  // An "OK" was ignored since the last send
+  CommandStats stats_;
+  bool running_ = false;  // Last START or STOP that completed
 };
 
-}  // namespace esphome::ld6001a
\ No newline at end of file
+}  // namespace esphome::ld6001a
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "command_queue.h"
+#include "read_params_tokenizer.h"
+
+namespace esphome::ld6001a {
+
+// Value of a parameter in a READ response, in the units of its write command: times in ms, distances in cm
+inline int32_t read_parameter(const ReadParamsResponse &params, CommandType type) {
+  switch (type) {
+    case CommandType::RANGE:
+      return params.range;
+    case CommandType::EXIT_BOUNDARY_TIME:
+      return std::lround(params.target_exit_time * 1000);
+    case CommandType::HEARTBEAT_INTERVAL:
+      return params.heart_beat_interval;
+    case CommandType::INSTALLATION_HEIGHT:
+      return params.detection_height;
+    case CommandType::RANGE_SENSITIVITY:
+      return params.range_sensitivity;
+    case CommandType::X_MIN:
+      return params.x_nega;
+    case CommandType::X_MAX:
+      return params.x_posi;
+    case CommandType::Y_MIN:
+      return params.y_nega;
+    case CommandType::Y_MAX:
+      return params.y_posi;
+    case CommandType::MOVING_TARGET_DISAPPEARANCE_TIME:
+      return std::lround(params.moving_target_disappearance_time * 1000);
+    case CommandType::STATIC_TARGET_DISAPPEARANCE_TIME:
+      return std::lround(params.static_target_disappearance_time * 1000);
+    default:
+      return 0;
+  }
+}
+
+// Parameters the radar should have, as configured in YAML. Parameters that are not set are left as the radar has
+// them, so the number entities keep working.
+//
+// The radar keeps its parameters over a power cycle, so on boot they usually match already. Instead of writing all of
+// them, diff() compares them against a READ response and only returns the writes for those that differ.
+class ConfigSync {
+ public:
+  void set(CommandType type, int32_t value) {
+    size_t slot = size_t(type) - size_t(CommandType::RANGE);
+    this->values_[slot] = value;
+    this->set_ |= 1u << slot;
+  }
+
+  bool empty() const { return this->set_ == 0; }
+
+  // Calls write(Command) for every set parameter that differs in params, returns the number of writes
+  template<typename F> size_t diff(const ReadParamsResponse &params, F &&write) const {
+    size_t count = 0;
+    for (size_t slot = 0; slot < WRITE_COMMAND_TYPES; slot++) {
+      if (!(this->set_ & (1u << slot))) {
+        continue;
+      }
+
+      auto type = CommandType(size_t(CommandType::RANGE) + slot);
+      if (read_parameter(params, type) != this->values_[slot]) {
+        write(Command::WriteCommand(type, this->values_[slot]));
+        count++;
+      }
+    }
+    return count;
+  }
+
+ protected:
+  std::array<int32_t, WRITE_COMMAND_TYPES> values_{};
+  uint32_t set_ = 0;  // Bit per slot of values_
+};
+
+}  // namespace esphome::ld6001a
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+
+namespace esphome {
+namespace ld6001a {
+
+// Fixed-capacity byte buffer for the UART frame parser.
+//
+// Bytes are appended at the tail and consumed from the head by advancing an offset, so dropping a byte or a whole
+// frame is O(1). The unread bytes are always contiguous; they are only moved back to the start of the storage when
+// the tail runs out of room. As long as the parser never holds more than half the capacity while waiting for a
+// frame to complete, that move is amortized O(1) per byte.
+template<size_t N> class FrameBuffer {
+ public:
+  // Appends as many bytes as fit and returns how many were stored. The remainder is counted as dropped.
+  size_t push(const uint8_t *data, size_t len) {
+    if (len > N - this->tail_ && this->head_ > 0) {
+      this->compact_();
+    }
+
+    size_t count = std::min(len, N - this->tail_);
+    std::memcpy(this->storage_.data() + this->tail_, data, count);
+    this->tail_ += count;
+    this->dropped_ += len - count;
+
+    return count;
+  }
+
+  bool push(uint8_t byte) { return this->push(&byte, 1) == 1; }
+
+  void consume(size_t count) {
+    this->head_ += std::min(count, this->size());
+
+    if (this->head_ == this->tail_) {
+      this->clear();
+    }
+  }
+
+  void clear() {
+    this->head_ = 0;
+    this->tail_ = 0;
+  }
+
+  const uint8_t *data() const { return this->storage_.data() + this->head_; }
+  size_t size() const { return this->tail_ - this->head_; }
+  bool empty() const { return this->head_ == this->tail_; }
+  size_t available() const { return N - this->size(); }
+  uint8_t operator[](size_t index) const { return this->storage_[this->head_ + index]; }
+
+  uint32_t get_dropped() const { return this->dropped_; }
+  static constexpr size_t capacity() { return N; }
+
+ protected:
+  void compact_() {
+    std::memmove(this->storage_.data(), this->storage_.data() + this->head_, this->size());
+    this->tail_ -= this->head_;
+    this->head_ = 0;
+  }
+
+  std::array<uint8_t, N> storage_{};
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  uint32_t dropped_ = 0;
+};
+
+}  // namespace ld6001a
+}  // namespace esphome
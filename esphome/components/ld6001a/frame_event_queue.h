@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdint.h>
+#include "frame_parser.h"
+#include "spsc_queue.h"
+
+namespace esphome::ld6001a {
+
+struct FrameEvent {
+  enum Type : uint8_t {
+    ACK,
+    SAVE_PARAM_FAILED,
+    READ_PARAMS,
+    SIMPLE_RADAR,
+    DETAILED_RADAR,
+    INVALID_FRAME,
+  };
+
+  Type type;
+  uint8_t people_counted;
+  std::array<Person, MAX_TARGETS> people;
+  ReadParamsResponse read_params;
+  std::array<char, MAX_AT_REPLY_LENGTH + 1> reply;
+};
+
+// Frame handler that records every callback as an event instead of handling it. The parser can then run in its own
+// task, while the events are replayed on the main loop with dispatch().
+template<size_t N> class FrameEventQueue : public FrameHandler {
+ public:
+  void on_at_reply(const char *reply) override {
+    std::strncpy(this->event_.reply.data(), reply, this->event_.reply.size() - 1);
+    this->push_(FrameEvent::ACK);
+  }
+  void on_save_param_failed() override { this->push_(FrameEvent::SAVE_PARAM_FAILED); }
+  void on_invalid_frame() override { this->push_(FrameEvent::INVALID_FRAME); }
+
+  void on_read_params_response(const ReadParamsResponse response) override {
+    this->event_.read_params = response;
+    this->push_(FrameEvent::READ_PARAMS);
+  }
+
+  void on_simple_radar_response(const uint8_t people_counted) override {
+    this->event_.people_counted = people_counted;
+    this->push_(FrameEvent::SIMPLE_RADAR);
+  }
+
+  void on_detailed_radar_response(Span<Person> people) override {
+    std::copy(people.begin(), people.end(), this->event_.people.begin());
+    this->event_.people_counted = people.size();
+    this->push_(FrameEvent::DETAILED_RADAR);
+  }
+
+  // Consumer side: replays all queued events on the given handler, returns the number of events handled
+  size_t dispatch(FrameHandler &handler) {
+    size_t count = 0;
+
+    while (this->queue_.pop(this->received_)) {
+      const auto &event = this->received_;
+
+      switch (event.type) {
+        case FrameEvent::ACK:
+          handler.on_at_reply(event.reply.data());
+          break;
+        case FrameEvent::SAVE_PARAM_FAILED:
+          handler.on_save_param_failed();
+          break;
+        case FrameEvent::READ_PARAMS:
+          handler.on_read_params_response(event.read_params);
+          break;
+        case FrameEvent::SIMPLE_RADAR:
+          handler.on_simple_radar_response(event.people_counted);
+          break;
+        case FrameEvent::DETAILED_RADAR:
+          handler.on_detailed_radar_response(Span<Person>(event.people.data(), event.people_counted));
+          break;
+        case FrameEvent::INVALID_FRAME:
+          handler.on_invalid_frame();
+          break;
+      }
+
+      count++;
+    }
+
+    return count;
+  }
+
+  // Events that were lost because the consumer did not keep up
+  uint32_t get_dropped() const { return this->queue_.get_dropped(); }
+
+ protected:
+  void push_(FrameEvent::Type type) {
+    this->event_.type = type;
+    this->queue_.push(this->event_);
+  }
+
+  FrameEvent event_{};     // Producer side scratch event
+  FrameEvent received_{};  // Consumer side scratch event
+  SpscQueue<FrameEvent, N> queue_;
+};
+
+}  // namespace esphome::ld6001a
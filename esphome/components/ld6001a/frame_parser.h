@@ -3,15 +3,19 @@
 #include <algorithm>
 #include <array>
 #include <string>
-#include <vector>
 #include <stdint.h>
 #include <cstddef>
 #include <cstring>
-#include "esphome/components/json/json_util.h"
 #include "esphome/core/log.h"
+#include "frame_buffer.h"
+#include "parser_stats.h"
+#include "read_params_tokenizer.h"
 
 namespace esphome::ld6001a {
 
+static const uint8_t MAX_TARGETS = 10;
+static const size_t MAX_AT_REPLY_LENGTH = 23;  // Longer replies are cut, they are only matched by command name
+
 enum class MatchResult { INVALID, PARTIAL, COMPLETE };
 
 union FloatBytes {
@@ -34,53 +38,99 @@ struct Person {
   float vz;
 };
 
-struct ReadParamsResponse {
-  std::string softwareVersion;
-  float range_res;
-  float vel_res;
-  int time;
-  int prog;
-  int range;
-  int range_sensitivity;
-  int heart_beat_interval;
-  int protocol_mode;
-  int detection_height;
-  int x_nega;
-  int x_posi;
-  int y_nega;
-  int y_posi;
-  float moving_target_disappearance_time;
-  float static_target_disappearance_time;
-  float target_exit_time;
+// Read-only view on a contiguous range of elements, used to hand fixed size buffers around without copying them
+template<typename T> class Span {
+ public:
+  Span() = default;
+  Span(const T *data, size_t size) : data_(data), size_(size) {}
+
+  const T *begin() const { return this->data_; }
+  const T *end() const { return this->data_ + this->size_; }
+  const T &operator[](size_t index) const { return this->data_[index]; }
+  size_t size() const { return this->size_; }
+  bool empty() const { return this->size_ == 0; }
+
+ protected:
+  const T *data_ = nullptr;
+  size_t size_ = 0;
 };
 
 enum class ParseState { IDLE, READING_HEADER, VALIDATING, COMPLETE, INVALID };
 
+enum class BinaryState { HEADER, LENGTH, BODY, CHECKSUM };
+
+enum class FrameKind : uint8_t { NONE, AT_REPLY, SIMPLE_RADAR, DETAILED_RADAR, READ_PARAMS, SAVE_PARAM_FAILED };
+
+// Every frame type starts with its own byte, so the first byte is enough to pick the only decoder that can match
+constexpr std::array<FrameKind, 256> make_frame_kinds() {
+  std::array<FrameKind, 256> kinds{};
+  kinds['A'] = FrameKind::AT_REPLY;
+  kinds[0x55] = FrameKind::SIMPLE_RADAR;
+  kinds[0x01] = FrameKind::DETAILED_RADAR;
+  kinds['{'] = FrameKind::READ_PARAMS;
+  kinds['S'] = FrameKind::SAVE_PARAM_FAILED;
+  return kinds;
+}
+
+static constexpr std::array<FrameKind, 256> FRAME_KINDS = make_frame_kinds();
+
 class FrameHandler {
  public:
   virtual void on_ack_response() {};
+  // Reply to an AT command with its text after "AT+", e.g. "OK" or an echo like "RANGE=300". The READ response
+  // arrives as "READ".
+  virtual void on_at_reply(const char *reply) { this->on_ack_response(); }
   virtual void on_save_param_failed() {};
   virtual void on_read_params_response(const ReadParamsResponse response){};
   virtual void on_simple_radar_response(const uint8_t people_counted) {};
-  virtual void on_detailed_radar_response(const std::vector<Person> people) {};
+  virtual void on_detailed_radar_response(Span<Person> people) {};
   virtual void on_invalid_frame() {};
   virtual ~FrameHandler() = default;
 };
 
 class FrameParser {
  public:
-  FrameParser(FrameHandler &handler) : state_(ParseState::IDLE), frame_handler_(handler) {}
+  using Clock = uint32_t (*)();
+
+  FrameParser(FrameHandler &handler) : state_(ParseState::IDLE), frame_handler_(&handler) {}
   ParseState state_;
 
+  // Route the callbacks of all following frames to another handler
+  void set_frame_handler(FrameHandler &handler) { frame_handler_ = &handler; }
+
   // Call this method to push data into the parser
   void push_data(const uint8_t byte) {
 
-    // ESP_LOGD("ld6001a", "push byte %X to %s", byte, format_hex(buffer_).c_str());
+    buffer_.push(byte);   // Add byte to the buffer
+    try_parse_frame_();  // Try to parse frame after every new byte
+  }
+
+  // Push a chunk of bytes, e.g. everything currently available on the UART. Frames are only searched for once per
+  // chunk instead of once per byte.
+  void push_data(const uint8_t *data, size_t len) {
+    if (len == 0) {
+      return;
+    }
+
+    // Parsing leaves at most MAX_FRAME_SIZE bytes behind, so every round has room for MAX_FRAME_SIZE more
+    while (len > 0) {
+      size_t count = buffer_.push(data, std::min(len, buffer_.available()));
+      try_parse_frame_();
 
-    buffer_.push_back(byte);  // Add byte to the buffer
-    try_parse_frame_();       // Try to parse frame after every new byte
+      data += count;
+      len -= count;
+    }
   }
 
+  const ParserStats &get_stats() const { return stats_; }
+
+  // The last completed resync run, see ResyncSummary
+  const ResyncSummary &get_last_resync() const { return last_resync_; }
+
+  // Time source for the resync summaries, e.g. millis(). Without one the elapsed time is reported as 0 and every
+  // summary is logged.
+  void set_clock(Clock clock) { clock_ = clock; }
+
   template<size_t N> void push_data(const std::array<uint8_t, N> &data) {
     for (const auto &byte : data) {
       push_data(byte);
@@ -98,10 +148,32 @@ class FrameParser {
   }
 
  private:
-  std::vector<uint8_t> buffer_;         // Input buffer for incoming bytes
-  std::vector<uint8_t> current_frame_;  // The current complete frame
+  static constexpr std::size_t MAX_FRAME_SIZE = 1024;
+
+  // Room for two maximum sized frames, so a partial frame never forces an expensive compaction
+  FrameBuffer<2 * MAX_FRAME_SIZE> buffer_;
   std::size_t body_len_ = 0;            // Length of the body for frames that include it
-  FrameHandler &frame_handler_;         // Reference to the frame handler
+  std::array<Person, MAX_TARGETS> people_{};  // People of the last detailed frame, reused for every frame
+  FrameHandler *frame_handler_;         // Pointer to the frame handler
+  ParserStats stats_;
+
+  // Invalid bytes are summarized per resync run instead of logged one by one
+  Clock clock_ = nullptr;
+  ResyncSummary resync_;
+  ResyncSummary last_resync_;
+  uint32_t last_resync_log_ms_ = 0;
+  uint32_t resyncs_suppressed_ = 0;  // Runs that were not logged because of the rate limit
+
+  // Incremental decoding of the binary frames, so every byte is looked at only once however often the matcher runs
+  BinaryState binary_state_ = BinaryState::HEADER;
+  std::size_t binary_scanned_ = 0;  // Number of buffered bytes that went through the state machine
+  uint8_t binary_checksum_ = 0;     // Running XOR over the bytes covered by the checksum
+
+  // Incremental decoding of the READ response, for the same reason
+  ReadParamsTokenizer read_tokenizer_;
+  std::size_t read_scanned_ = 0;
+
+  static constexpr uint32_t RESYNC_LOG_INTERVAL = 1000;  // Min ms between two logged resync summaries
 
   float read_float(const uint8_t *ptr) {
     float value;
@@ -115,171 +187,121 @@ class FrameParser {
     return value;
   }
 
-  void replaceAll(std::string& str, const std::string& from, const std::string& to) {
-    if (from.empty()) return;
-    size_t startPos = 0;
-    while ((startPos = str.find(from, startPos)) != std::string::npos) {
-        str.replace(startPos, from.length(), to);
-        startPos += to.length(); // Move past the replacement
-    }
-  }
-
   void try_parse_frame_() {
-    bool invalid = false;
-    bool partial = false;
-    bool complete = false;
-    using MatcherFn = MatchResult (FrameParser::*)();
-
-    MatcherFn matchers[] = {
-      &FrameParser::match_at_ok_,
-      &FrameParser::match_binary_type1_,
-      &FrameParser::match_binary_type2_,
-      &FrameParser::match_read_response_,
-    };
+    MatchResult result;
 
     do {
-      invalid = true;
-      complete = false;
-      partial = false;
-
-      for (const auto &matcher : matchers) {
-        MatchResult result = (this->*matcher)();
-        if (result == MatchResult::COMPLETE) {
-          complete = true;
-          invalid = false;
-          partial = false;
-          break;
-        } else if (result == MatchResult::PARTIAL) {
-          partial = true;
-          invalid = false;
-        } else if (result == MatchResult::INVALID) {
-          invalid = !partial && true;
-        }
-      }
+      result = this->match_frame_();
 
-      if (complete) {
+      if (result == MatchResult::COMPLETE) {
         state_ = ParseState::IDLE;
-      } if (partial) {
+        this->finish_resync_();
+      } else if (result == MatchResult::PARTIAL) {
         this->state_ = ParseState::READING_HEADER;
-      } else if (invalid) {
+      } else {
         state_ = ParseState::INVALID;
-        drain_one_byte();
+        drain_invalid_bytes_();
       }
 
-      // invalid buffer
-      if (buffer_.size() > 1024) {
+      // A partial frame longer than any frame can be, give up on it. Complete and invalid frames leave the buffer
+      // shorter on every round, a large chunk is fine as long as it keeps matching.
+      if (result == MatchResult::PARTIAL && buffer_.size() > MAX_FRAME_SIZE) {
+          stats_.buffer_overflows++;
+          stats_.bytes_discarded += buffer_.size();
           buffer_.clear();
+          this->reset_binary_frame_();
+          this->reset_read_response_();
       }
-    } while ((buffer_.size() > 0) && invalid);
+    } while ((buffer_.size() > 0) && result != MatchResult::PARTIAL);
+  }
+
+  MatchResult match_frame_() {
+    switch (FRAME_KINDS[buffer_[0]]) {
+      case FrameKind::AT_REPLY:
+        return this->match_at_ok_();
+      case FrameKind::SIMPLE_RADAR:
+        return this->match_binary_type1_();
+      case FrameKind::DETAILED_RADAR:
+        return this->match_binary_type2_();
+      case FrameKind::READ_PARAMS:
+        return this->match_read_response_();
+      case FrameKind::SAVE_PARAM_FAILED:
+        return this->match_save_para_fail_();
+      default:
+        return MatchResult::INVALID;
+    }
   }
 
   MatchResult match_save_para_fail_() {
-    std::string marker = "Save Para Fail\r\n"; // 16 chars
+    static const char marker[] = "Save Para Fail\r\n"; // 16 chars
     auto buffer_size = buffer_.size();
     auto match_size = std::min<size_t>(16, buffer_size);
 
-    auto match = std::equal(marker.begin(), marker.begin() + match_size, buffer_.begin());
+    auto match = std::equal(marker, marker + match_size, buffer_.data());
 
     if (!match) {
       return MatchResult::INVALID;
     } else if (buffer_size < 16) {
       return MatchResult::PARTIAL;
     } else {
-      buffer_.erase(buffer_.begin(), buffer_.begin() + 16);  // Remove the processed part from the buffer
-      this->frame_handler_.on_save_param_failed();
+      buffer_.consume(16);  // Remove the processed part from the buffer
+      stats_.count_frame(FrameType::SAVE_PARAM_FAILED);
+      this->frame_handler_->on_save_param_failed();
 
       return MatchResult::COMPLETE;
     }
   }
 
   MatchResult match_read_response_() {
-    if (buffer_[0] != '{') {
-      return MatchResult::INVALID;
+    while (read_scanned_ < buffer_.size()) {
+      switch (read_tokenizer_.feed(buffer_[read_scanned_])) {
+        case ReadParamsTokenizer::Result::MORE:
+          read_scanned_++;
+          break;
+        case ReadParamsTokenizer::Result::DONE:
+          return this->complete_read_response_(read_scanned_ + 1);
+        case ReadParamsTokenizer::Result::DONE_BEFORE:
+          return this->complete_read_response_(read_scanned_);
+        case ReadParamsTokenizer::Result::INVALID:
+          this->reset_read_response_();
+          return MatchResult::INVALID;
+      }
     }
 
-    std::string target_exit_marker = "Target exit";
-    auto target_exit_pos = std::search(buffer_.begin(), buffer_.end(), target_exit_marker.begin(), target_exit_marker.end());
-
-    if (target_exit_pos == buffer_.end()) {
-      return MatchResult::PARTIAL;
+    if (read_tokenizer_.is_complete()) {
+      return this->complete_read_response_(read_scanned_);
     }
 
-    std::string end_marker = "}";
-    auto end_pos = std::search(target_exit_pos, buffer_.end(), end_marker.begin(), end_marker.end());
+    return MatchResult::PARTIAL;
+  }
 
-    // Some older firmware do not return a } as end token.
-    if (end_pos == buffer_.end()) {
-      std::string old_end_marker = "s,";
-      end_pos = std::search(target_exit_pos, buffer_.end(), old_end_marker.begin(), old_end_marker.end());
-    }
+  MatchResult complete_read_response_(size_t frame_len) {
+    ReadParamsResponse response = read_tokenizer_.get_response();
 
-    // Neither token is found (yet).
-    if (end_pos == buffer_.end()) {
-      return MatchResult::PARTIAL;
-    }
+    buffer_.consume(frame_len);  // Remove the processed part from the buffer
+    this->reset_read_response_();
 
-    std::string response(buffer_.begin(), end_pos);
-
-    ESP_LOGD("ld6001a", "Found READ response: %s", response.c_str());
-
-    buffer_.erase(buffer_.begin(), end_pos + 1);  // Remove the processed part from the buffer
-  
-    // It looks like JSON, but it isnt. Try to fix it
-    replaceAll(response, "\x09\x0a", "\r\n");
-    replaceAll(response, "\xa3\xba", " ");
-    replaceAll(response, "\nMoving target", "\n\"Moving target\":");
-    replaceAll(response, "\nStatic target", "\n\"Static target\":");
-    replaceAll(response, "\nTarget exit", "\n\"Target exit\":");
-    replaceAll(response, "NOP_1.07-01", "\"NOP_1.07-01\"");
-    replaceAll(response, "SoftwareVersion", "PeopleCntSoftVerison");  // for the version older than NOP_1.07
-    replaceAll(response, "\"Time\"", "\"TIME\"");  // for the version older than NOP_1.07
-    replaceAll(response, "\"Prog\"", "\"PROG\"");  // for the version older than NOP_1.07
-    replaceAll(response, "s,", ",");
-
-    response += "}";
-
-    replaceAll(response, ",\r\n}", "\r\n}");
-
-    ESP_LOGW("ld6001a", "Fixed READ response: %s", response.c_str());
-
-    json::parse_json(response, [this](ArduinoJson::JsonObject obj) -> bool {
-      ReadParamsResponse read_params_response;
-      read_params_response.softwareVersion = obj["PeopleCntSoftVerison"].as<std::string>();
-      read_params_response.range_res = obj["RangeRes"].as<float>();
-      read_params_response.vel_res = obj["VelRes"].as<float>();
-      read_params_response.time = obj["TIME"].as<int>();
-      read_params_response.prog = obj["PROG"].as<int>();
-      read_params_response.range = obj["Range"].as<int>();
-      read_params_response.range_sensitivity = obj["Sen"].as<int>();
-      read_params_response.heart_beat_interval = obj["Heart_Time"].as<int>();
-      read_params_response.protocol_mode = obj["Debug"].as<int>();
-      read_params_response.detection_height = obj["detectionHeight"].as<int>();
-      read_params_response.x_nega = obj["XboundaryN"].as<int>();
-      read_params_response.x_posi = obj["XboundaryP"].as<int>();
-      read_params_response.y_nega = obj["YboundaryN"].as<int>();
-      read_params_response.y_posi = obj["YboundaryP"].as<int>();
-      read_params_response.moving_target_disappearance_time = obj["Moving target"].as<float>();
-      read_params_response.static_target_disappearance_time = obj["Static target"].as<float>();
-      read_params_response.target_exit_time = obj["Target exit"].as<float>();
-
-      this->frame_handler_.on_ack_response();
-      this->frame_handler_.on_read_params_response(read_params_response);
-
-      return true;
-      // ESP_LOGW("ld6001a", "Parsed READ response: %s", format_hex_pretty(buffer_).c_str());
-    });
+    ESP_LOGD("ld6001a", "Found READ response from firmware %s", response.software_version.data());
 
+    stats_.count_frame(FrameType::READ_PARAMS);
+    this->frame_handler_->on_at_reply("READ");
+    this->frame_handler_->on_read_params_response(response);
 
     return MatchResult::COMPLETE;
   }
 
+  void reset_read_response_() {
+    read_tokenizer_.reset();
+    read_scanned_ = 0;
+  }
+
   MatchResult match_at_ok_() {
     auto buffer_size = buffer_.size();
     auto match_size = std::min<size_t>(3, buffer_size);
     const std::string prefix = "AT+";
     const std::string suffix = "\r\n";
 
-    bool match = std::equal(prefix.begin(), prefix.begin() + match_size, buffer_.begin());
+    bool match = std::equal(prefix.begin(), prefix.begin() + match_size, buffer_.data());
 
     if (!match) {
       return MatchResult::INVALID;
@@ -309,10 +331,15 @@ class FrameParser {
 
     // Check suffix
     if (buffer_[pos] == '\r' && buffer_[pos + 1] == '\n') {
+      char reply[MAX_AT_REPLY_LENGTH + 1];
+      size_t length = std::min(pos - prefix.size(), MAX_AT_REPLY_LENGTH);
+      std::copy(buffer_.data() + prefix.size(), buffer_.data() + prefix.size() + length, reply);
+      reply[length] = '\0';
 
-      buffer_.erase(buffer_.begin(), buffer_.begin() + pos+1 + 1);
+      buffer_.consume(pos + suffix.size());
 
-      this->frame_handler_.on_ack_response();
+      stats_.count_frame(FrameType::ACK);
+      this->frame_handler_->on_at_reply(reply);
 
       return MatchResult::COMPLETE;
     }
@@ -321,123 +348,192 @@ class FrameParser {
   }
 
   MatchResult match_binary_type1_() {
-    auto buffer_size = buffer_.size();
-    auto match_size = std::min<size_t>(2, buffer_size);
     static const std::array<uint8_t, 2> header = {0x55, 0xAA};
 
-    auto match = std::equal(buffer_.begin(), buffer_.begin() + match_size, header.begin());
-
-    if (!match) {
-      return MatchResult::INVALID;
-    }
-
-    if (buffer_size < header.size()) {
-     return MatchResult::PARTIAL;
-    }
+    // Layout: 0x55 0xAA <length> ... <count> <checksum>, the length covers the whole frame and the checksum is the
+    // XOR of everything from the length byte up to the checksum.
+    while (binary_scanned_ < buffer_.size()) {
+      size_t index = binary_scanned_++;
+      uint8_t byte = buffer_[index];
+
+      switch (binary_state_) {
+        case BinaryState::HEADER:
+          if (byte != header[index]) {
+            return this->reject_binary_frame_();
+          }
+          if (index + 1 == header.size()) {
+            binary_state_ = BinaryState::LENGTH;
+          }
+          break;
 
-    state_ = ParseState::READING_HEADER;
-    
-    auto frame_type = buffer_[2];
-    body_len_ = buffer_[2];  // Body length is the 3rd byte in type 1
+        case BinaryState::LENGTH:
+          body_len_ = byte;
+          if (body_len_ < 10) {
+            return this->reject_binary_frame_();
+          }
+          binary_checksum_ ^= byte;
+          binary_state_ = BinaryState::BODY;
+          break;
 
-     if (buffer_size < body_len_) {
-      // Not enough for body
-      return MatchResult::PARTIAL;
-     }
+        case BinaryState::BODY:
+          binary_checksum_ ^= byte;
+          if (index + 2 == body_len_) {
+            binary_state_ = BinaryState::CHECKSUM;
+          }
+          break;
 
-     if (!validate_frame()) {
-      return MatchResult::INVALID;
-     }
+        case BinaryState::CHECKSUM:
+          if (byte != binary_checksum_) {
+            stats_.checksum_failures++;
+            return this->reject_binary_frame_();
+          }
+
+          auto people_counted = buffer_[8];
+          buffer_.consume(body_len_);  // Remove the processed part from the buffer
+          this->reset_binary_frame_();
+          stats_.count_frame(FrameType::SIMPLE_RADAR);
+          this->frame_handler_->on_simple_radar_response(people_counted);
+          return MatchResult::COMPLETE;
+      }
+    }
 
-     buffer_.erase(buffer_.begin(), buffer_.begin() + body_len_);  // Remove the processed part from the buffer
-     this->frame_handler_.on_simple_radar_response(buffer_[8]);
-     return MatchResult::COMPLETE;
+    return MatchResult::PARTIAL;
   }
 
   MatchResult match_binary_type2_() {
-    auto buffer_size = buffer_.size();
-    auto match_size = std::min<size_t>(8, buffer_size);
     static const std::array<uint8_t, 8> header = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
 
-    bool match = std::equal(header.begin(), header.begin() + match_size, buffer_.begin());
-    if (!match) {
-      return MatchResult::INVALID;
-    } else if (buffer_size < header.size() + 4) {
-      return MatchResult::PARTIAL;
-    }
+    // Layout: 8 byte magic, uint32 length (frame size minus the checksum), 20 more header bytes, 32 bytes per
+    // person and a checksum. The checksum is the XOR of bytes 12..15 and everything from byte 32 on.
+    while (binary_scanned_ < buffer_.size()) {
+      size_t index = binary_scanned_++;
+      uint8_t byte = buffer_[index];
+
+      switch (binary_state_) {
+        case BinaryState::HEADER:
+          if (byte != header[index]) {
+            return this->reject_binary_frame_();
+          }
+          if (index + 1 == header.size()) {
+            binary_state_ = BinaryState::LENGTH;
+          }
+          break;
 
-    auto body_len_ = read_uint32(&buffer_[8]) + 1;
+        case BinaryState::LENGTH:
+          if (index + 1 == header.size() + sizeof(uint32_t)) {
+            body_len_ = read_uint32(buffer_.data() + header.size()) + 1;
+            if (body_len_ < 33 || body_len_ > MAX_FRAME_SIZE) {
+              return this->reject_binary_frame_();
+            }
+            binary_state_ = BinaryState::BODY;
+          }
+          break;
 
-    if (buffer_size < body_len_) {
-      // Not enough for body
-      return MatchResult::PARTIAL;
-    }
+        case BinaryState::BODY:
+          if ((index >= 12 && index < 16) || index >= 32) {
+            binary_checksum_ ^= byte;
+          }
+          if (index + 2 == body_len_) {
+            binary_state_ = BinaryState::CHECKSUM;
+          }
+          break;
 
-    if (!validate_frame()) {
-      return MatchResult::INVALID;
+        case BinaryState::CHECKSUM:
+          if (byte != binary_checksum_) {
+            stats_.checksum_failures++;
+            return this->reject_binary_frame_();
+          }
+
+          this->reset_binary_frame_();
+          process_binary_type2_response(body_len_);
+          return MatchResult::COMPLETE;
+      }
     }
 
-     process_binary_type2_response();
+    return MatchResult::PARTIAL;
+  }
 
-     return MatchResult::COMPLETE;
+  MatchResult reject_binary_frame_() {
+    this->reset_binary_frame_();
+    return MatchResult::INVALID;
   }
 
-  void drain_one_byte() {
-    ESP_LOGE("ld6001a", "drain single byte from: %s", format_hex_pretty(buffer_).c_str());
+  void reset_binary_frame_() {
+    binary_state_ = BinaryState::HEADER;
+    binary_scanned_ = 0;
+    binary_checksum_ = 0;
+  }
+
+  // Drops the invalid first byte together with everything up to the next possible frame start, so a run of garbage
+  // is skipped at once instead of byte by byte. Skipping only advances the read offset of the buffer.
+  void drain_invalid_bytes_() {
+    this->reset_binary_frame_();
+    this->reset_read_response_();
+
+    if (buffer_.empty()) {
+      return;
+    }
+
+    auto next = std::find_if(buffer_.data() + 1, buffer_.data() + buffer_.size(),
+                             [](uint8_t byte) { return FRAME_KINDS[byte] != FrameKind::NONE; });
+    size_t count = next - buffer_.data();
 
-    if (!buffer_.empty()) {
-      buffer_.erase(buffer_.begin());
+    if (resync_.skipped == 0) {
+      resync_.started_ms = this->now_();
     }
+    resync_.add(buffer_.data(), count);
+    stats_.bytes_discarded += count;
+
+    buffer_.consume(count);
   }
 
-  bool validate_frame() {
-    auto expected_checksum = buffer_[buffer_.size() - 1];
+  void finish_resync_() {
+    if (resync_.skipped == 0) {
+      return;
+    }
 
-    if (buffer_[0] == 0x55 && buffer_[1] == 0xAA) {
-      uint8_t calculated_checksum = 0;
-      for (size_t i = 2; i < buffer_.size() - 1; ++i) {
-        calculated_checksum ^= buffer_[i];
-      }
+    uint32_t now = this->now_();
+    resync_.elapsed_ms = now - resync_.started_ms;
+    stats_.resyncs++;
 
-      return expected_checksum == calculated_checksum;
+    if (clock_ == nullptr || now - last_resync_log_ms_ >= RESYNC_LOG_INTERVAL) {
+      ESP_LOGW("ld6001a", "Resynced after skipping %u bytes in %u ms (%u more not logged): %s", resync_.skipped,
+               resync_.elapsed_ms, resyncs_suppressed_,
+               format_hex_pretty(resync_.sample.data(), resync_.sample_len).c_str());
+      last_resync_log_ms_ = now;
+      resyncs_suppressed_ = 0;
     } else {
-      uint8_t calculted_checksum = 0;
-      for (size_t i = 12; i < 16; ++i) {
-        calculted_checksum ^= buffer_[i];
-      }
-      for (size_t i = 32; i < buffer_.size() - 1; ++i) {
-        calculted_checksum ^= buffer_[i];
-      }
-
-      return expected_checksum == calculted_checksum;
+      resyncs_suppressed_++;
     }
+
+    last_resync_ = resync_;
+    resync_ = ResyncSummary{};
   }
 
-  void process_binary_type2_response() {
-    Uint32Bytes u32 = {.bytes{buffer_[28], buffer_[29], buffer_[30], buffer_[31]}};
-    auto people_count = u32.u / 32;  // Assuming 4th byte is people count
+  uint32_t now_() const { return clock_ != nullptr ? clock_() : 0; }
 
-    std::vector<Person> people;
-    people.reserve(u32.u / 32);
+  void process_binary_type2_response(size_t frame_len) {
+    Uint32Bytes u32 = {.bytes{buffer_[28], buffer_[29], buffer_[30], buffer_[31]}};
+    // Never read past the frame, even if the track length disagrees with the frame length
+    auto people_count = std::min<size_t>({u32.u / 32, (frame_len - 33) / 32, MAX_TARGETS});
 
     for (size_t i = 0; i < people_count; ++i) {
       auto offset = i * 32 + 32;  // Start reading from the 33rd byte
-      Person person = {
-          .id = read_uint32(&buffer_[offset + 4]),
-          .x = read_float(&buffer_[offset + 8]),
-          .y = read_float(&buffer_[offset + 12]),
-          .z = read_float(&buffer_[offset + 16]),
-          .vx = read_float(&buffer_[offset + 20]),
-          .vy = read_float(&buffer_[offset + 24]),
-          .vz = read_float(&buffer_[offset + 28]),
+      people_[i] = Person{
+          .id = read_uint32(buffer_.data() + offset + 4),
+          .x = read_float(buffer_.data() + offset + 8),
+          .y = read_float(buffer_.data() + offset + 12),
+          .z = read_float(buffer_.data() + offset + 16),
+          .vx = read_float(buffer_.data() + offset + 20),
+          .vy = read_float(buffer_.data() + offset + 24),
+          .vz = read_float(buffer_.data() + offset + 28),
       };
-
-      people.push_back(person);
     }
 
-    buffer_.clear();
+    buffer_.consume(frame_len);  // Remove the processed part from the buffer
 
-    this->frame_handler_.on_detailed_radar_response(people);  // Assuming 4th byte is people count
+    stats_.count_frame(FrameType::DETAILED_RADAR);
+    this->frame_handler_->on_detailed_radar_response(Span<Person>(people_.data(), people_count));
   }
 };
 
@@ -20,69 +20,189 @@ LD6001AComponent::LD6001AComponent() : Component() {}
 void LD6001AComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up HLK-LD6001A...");
 
-  this->command_queue_.enqueue(Command::ResetCommand());
-  this->set_protocol_mode(ProtocolMode::PROTOCOL_MODE_DETAILED);
-  this->start();
-  this->command_queue_.enqueue(Command::ReadCommand());
+  this->frame_parser_.set_clock(millis);
+
+  bool synced = false;
+#ifdef USE_LD6001A_WARM_START
+  synced = this->restore_warm_state_();
+#endif
+
+  if (synced) {
+    // Same configuration as when the radar last had the configured parameters, only the protocol mode is checked
+    ESP_LOGI(TAG, "Parameters in sync since last boot");
+    this->sync_state_ = SyncState::VERIFYING;
+    this->set_synced_(false);  // Until the READ confirms it
+    this->start();
+    this->command_queue_.enqueue(Command::ReadCommand(), millis());
+  } else {
+    // The radar keeps its parameters over a power cycle. Read them first and only write those that differ, instead of
+    // resetting it and writing all of them. A radar that does not answer quickly is reset instead.
+    this->sync_state_ = SyncState::READING;
+    this->command_queue_.enqueue(Command::ReadCommand().with_timeout(BOOT_READ_TIMEOUT).with_retries(1), millis());
+  }
 
   uint32_t hash = fnv1_hash(App.get_friendly_name());
-  this->pref_ = global_preferences->make_preference<ZoneCoordinates[MAX_ZONES]>(hash, true);
+  this->pref_ = global_preferences->make_preference<ZoneCoordinates[MAX_NUMBER_ZONES]>(hash, true);
 
-  ZoneCoordinates zones[MAX_ZONES];
+  ZoneCoordinates zones[MAX_NUMBER_ZONES];
 
   if (this->pref_.load(&zones)) {
-    ESP_LOGW(TAG, "Loaded %d zones from preferences", MAX_ZONES);
+    ESP_LOGW(TAG, "Loaded %d zones from preferences", MAX_NUMBER_ZONES);
+
+    for (size_t i = 0; i < MAX_NUMBER_ZONES && i < this->zones_.size(); i++) {
+      if (this->zones_.is_polygon(i)) {
+        continue;  // Configured in YAML, the stored rectangle is only its bounding box
+      }
 
-    for (size_t i = 0; i < MAX_ZONES; i++) {
       maybe_publish(this->zone_numbers_[i].x1, zones[i].x1);
       maybe_publish(this->zone_numbers_[i].x2, zones[i].x2);
       maybe_publish(this->zone_numbers_[i].y1, zones[i].y1);
       maybe_publish(this->zone_numbers_[i].y2, zones[i].y2);
 
-      this->zone_config_[i].x1 = zones[i].x1;
-      this->zone_config_[i].x2 = zones[i].x2;
-      this->zone_config_[i].y1 = zones[i].y1;
-      this->zone_config_[i].y2 = zones[i].y2;
+      this->zones_.set_rectangle(i, zones[i].x1, zones[i].y1, zones[i].x2, zones[i].y2);
     }
 
   } else {
     ESP_LOGW(TAG, "No zones found in preferences");
   }
+
+#ifdef USE_SENSOR
+  this->last_diagnostics_millis_ = millis();
+  this->set_interval("diagnostics", DIAGNOSTICS_INTERVAL, [this]() { this->publish_diagnostics_(); });
+#endif
+
+#ifdef USE_LD6001A_HEATMAP
+  if (this->heatmap_decay_interval_ > 0) {
+    this->set_interval("heatmap_decay", this->heatmap_decay_interval_,
+                       [this]() { this->heatmap_.decay(this->heatmap_decay_factor_); });
+  }
+#endif
+
+#ifdef USE_LD6001A_PARSER_TASK
+  if (this->parser_task_) {
+    // From now on frames are parsed on the other core, loop() only picks up the results
+    this->frame_parser_.set_frame_handler(this->frame_events_);
+
+    if (xTaskCreatePinnedToCore(parser_task_loop_, "ld6001a_parser", PARSER_TASK_STACK_SIZE, this, 5,
+                                &this->parser_task_handle_, 0) != pdPASS) {
+      ESP_LOGE(TAG, "Could not start parser task, parsing in loop()");
+      this->frame_parser_.set_frame_handler(*this);
+      this->parser_task_ = false;
+    }
+  }
+#endif
 }
 
-void LD6001AComponent::dump_config() { ESP_LOGCONFIG(TAG, "HLK-LD6001A Human motion tracking radar module:"); }
+void LD6001AComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "HLK-LD6001A Human motion tracking radar module:");
+  ESP_LOGCONFIG(TAG, "  Parser task : %s", YESNO(this->parser_task_));
+  if (this->event_driven_) {
+    ESP_LOGCONFIG(TAG, "  Publishing : on frames, coalesced within %ums", this->coalesce_window_);
+  } else {
+    ESP_LOGCONFIG(TAG, "  Publishing : every %ums", this->throttle_);
+  }
+  ESP_LOGCONFIG(TAG, "  Parameters : %s", this->config_sync_.empty() ? "as on the radar" : "synced on boot");
+  ESP_LOGCONFIG(TAG, "  Smoothing : %s", YESNO(this->target_tracker_.is_smoothing()));
+  ESP_LOGCONFIG(TAG, "  Zones : %u", this->zones_.size());
+  for (size_t i = 0; i < this->zones_.size(); i++) {
+    if (this->zones_.is_polygon(i)) {
+      auto bounds = this->zones_.get_bounds(i);
+      ESP_LOGCONFIG(TAG, "  Zone %u : polygon of %u vertices within (%d, %d) (%d, %d)", i + 1,
+                    this->zones_.get_vertex_count(i), bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    }
+  }
+#ifdef USE_LD6001A_HEATMAP
+  ESP_LOGCONFIG(TAG, "  Heatmap : %ux%u cells of %u cm", this->heatmap_.get_columns(), this->heatmap_.get_rows(),
+                this->heatmap_.get_cell_size());
+#endif
+
+  const auto &stats = this->get_parser_stats();
+  ESP_LOGCONFIG(TAG, "  Frames : %u detailed, %u simple, %u ack, %u read, %u save failed",
+                stats.get_frames(FrameType::DETAILED_RADAR), stats.get_frames(FrameType::SIMPLE_RADAR),
+                stats.get_frames(FrameType::ACK), stats.get_frames(FrameType::READ_PARAMS),
+                stats.get_frames(FrameType::SAVE_PARAM_FAILED));
+  ESP_LOGCONFIG(TAG, "  Link errors : %u bytes discarded in %u resyncs, %u checksum failures, %u buffer overflows",
+                uint32_t(stats.bytes_discarded), uint32_t(stats.resyncs), uint32_t(stats.checksum_failures),
+                uint32_t(stats.buffer_overflows));
+  ESP_LOGCONFIG(TAG, "  Commands : %u sent, %u retries, %u failed", this->get_command_stats().sent,
+                this->get_command_stats().retries, this->get_command_stats().failures);
+#ifdef USE_LD6001A_CAPTURE
+  ESP_LOGCONFIG(TAG, "  UART capture : %u bytes recorded", this->capture_recorder_.get_bytes_recorded());
+#endif
+}
 
 void LD6001AComponent::loop() {
-  uint8_t byte;
+#ifdef USE_LD6001A_PARSER_TASK
+  if (this->parser_task_) {
+    this->frame_events_.dispatch(*this);
+  } else {
+    this->read_uart_();
+  }
+#else
+  this->read_uart_();
+#endif
 
-  // Read data from the UART and push it to the frame parser
-  while (this->available()) {
-    if (this->read_byte(&byte)) {
-      this->frame_parser_.push_data(byte);
+#ifdef USE_LD6001A_CAPTURE
+  if (millis() - this->last_capture_flush_millis_ >= CAPTURE_FLUSH_INTERVAL) {
+    this->last_capture_flush_millis_ = millis();
+    this->capture_recorder_.flush();
+  }
+#endif
+
+  command_queue_.loop(millis());
+  if (!this->event_driven_) {
+    update_sensors_();
+  }
+}
+
+void LD6001AComponent::read_uart_() {
+  uint8_t buffer[UART_CHUNK_SIZE];
+  uint32_t start = micros();
+  bool ingested = false;
+
+  // Read everything that is available from the UART in chunks and push it to the frame parser at once
+  while (size_t available = this->available()) {
+    size_t len = std::min(available, sizeof(buffer));
+    if (!this->read_array(buffer, len)) {
+      break;
     }
+#ifdef USE_LD6001A_CAPTURE
+    this->capture_recorder_.record(millis(), buffer, len);
+#endif
+    this->frame_parser_.push_data(buffer, len);
+    ingested = true;
   }
 
-  command_queue_.loop();
-  update_sensors_();
+  // Calls without data would only drag the average down
+  if (ingested) {
+    this->ingest_stats_.add(micros() - start);
+  }
 }
 
+#ifdef USE_LD6001A_PARSER_TASK
+void LD6001AComponent::parser_task_loop_(void *param) {
+  auto *component = static_cast<LD6001AComponent *>(param);
+
+  while (true) {
+    component->read_uart_();
+    vTaskDelay(1);  // One tick is far less than it takes to fill the UART buffer
+  }
+}
+#endif
+
 void LD6001AComponent::start() {
   ESP_LOGW(TAG, "Starting HLK-LD6001A...");
-
-  this->command_queue_.enqueue(
-      Command::StartCommand([this](const std::string &response) { ESP_LOGW(TAG, "HLK-LD6001A started"); }));
+  this->command_queue_.enqueue(Command::StartCommand(), millis());
 }
 
 void LD6001AComponent::stop() {
   ESP_LOGW(TAG, "Stopping HLK-LD6001A...");
-  this->command_queue_.enqueue(
-      Command::StopCommand([this](const std::string &response) { ESP_LOGW(TAG, "HLK-LD6001A stopped"); }));
+  this->command_queue_.enqueue(Command::StopCommand(), millis());
 }
 
 void LD6001AComponent::soft_reset() {
   ESP_LOGD(TAG, "Resetting HLK-LD6001A...");
-  this->command_queue_.enqueue(
-      Command::ResetCommand([this](const std::string &response) { ESP_LOGD(TAG, "HLK-LD6001A reset"); }));
+  this->command_queue_.enqueue(Command::ResetCommand(), millis());
 }
 
 void LD6001AComponent::reset() {
@@ -102,97 +222,62 @@ void LD6001AComponent::reset() {
 
 void LD6001AComponent::config_factory_settings() {
   ESP_LOGW(TAG, "Configuring factory settings...");
-
-  this->command_queue_.enqueue(Command::RestoreCommand([this](const std::string &response) {
-    ESP_LOGW(TAG, "Factory settings configured");
-    this->command_queue_.send(Command::ReadCommand());
-  }));
+  this->command_queue_.enqueue(Command::RestoreCommand(), millis());
 }
 
 void LD6001AComponent::set_protocol_mode(ProtocolMode mode) {
   ESP_LOGD(TAG, "Setting protocol mode to %d", mode);
-  this->command_queue_.enqueue(Command::SetProtocolModeCommand(
-      mode, [this, mode](const std::string &response) { ESP_LOGD(TAG, "Protocol mode set to %d", mode); }));
+  this->command_queue_.enqueue(Command::SetProtocolModeCommand(mode), millis());
 }
 
 void LD6001AComponent::config_distance_sensitivity(uint8_t sensitivity) {
   ESP_LOGW(TAG, "Configuring distance sensitivity: %d", sensitivity);
-
-  this->command_queue_.enqueue(
-      Command::RangeSensitivityCommand(sensitivity, [this, sensitivity](const std::string &response) {
-        ESP_LOGW(TAG, "Distance sensitivity configured: %d", sensitivity);
-      }));
+  this->command_queue_.enqueue(Command::RangeSensitivityCommand(sensitivity), millis());
 }
 
 void LD6001AComponent::config_heartbeat_interval(uint16_t interval_s) {
   ESP_LOGW(TAG, "Configuring heartbeat interval: %d s", interval_s);
-
-  this->command_queue_.enqueue(
-      Command::HeartBeatIntervalCommand(interval_s, [this, interval_s](const std::string &response) {
-        ESP_LOGW(TAG, "Heart beat interval configured: %d s", interval_s);
-      }));
+  this->command_queue_.enqueue(Command::HeartBeatIntervalCommand(interval_s), millis());
 }
 
 void LD6001AComponent::config_vertical_distance(int distance_cm) {
   ESP_LOGW(TAG, "Configuring vertical distance: %d cm", distance_cm);
-
-  this->command_queue_.enqueue(
-      Command::InstallationHeightCommand(distance_cm, [this, distance_cm](const std::string &response) {
-        ESP_LOGW(TAG, "Vertical distance configured: %d cm", distance_cm);
-      }));
+  this->command_queue_.enqueue(Command::InstallationHeightCommand(distance_cm), millis());
 }
 
 void LD6001AComponent::config_ground_radius(uint16_t radius_cm) {
   ESP_LOGW(TAG, "Configuring ground radius: %d cm", radius_cm);
-
-  this->command_queue_.enqueue(Command::RangeCommand(radius_cm, [this, radius_cm](const std::string &response) {
-    ESP_LOGW(TAG, "Ground radius configured: %d cm", radius_cm);
-  }));
+  this->command_queue_.enqueue(Command::RangeCommand(radius_cm), millis());
 }
 
 void LD6001AComponent::config_x_min(int x_min) {
   ESP_LOGW(TAG, "Configuring XNega: %d cm", x_min);
-
-  this->command_queue_.enqueue(Command::XMinCommand(
-      x_min, [this, x_min](const std::string &response) { ESP_LOGW(TAG, "XNega configured: %d cm", x_min); }));
+  this->command_queue_.enqueue(Command::XMinCommand(x_min), millis());
 }
 
 void LD6001AComponent::config_x_max(int x_max) {
   ESP_LOGW(TAG, "Configuring XPosi: %d cm", x_max);
-
-  this->command_queue_.enqueue(Command::XMaxCommand(
-      x_max, [this, x_max](const std::string &response) { ESP_LOGW(TAG, "XPosi configured: %d cm", x_max); }));
+  this->command_queue_.enqueue(Command::XMaxCommand(x_max), millis());
 }
 
 void LD6001AComponent::config_y_min(int y_min) {
   ESP_LOGW(TAG, "Configurting YNega: %d cm", y_min);
-
-  this->command_queue_.enqueue(Command::YMinCommand(
-      y_min, [this, y_min](const std::string &response) { ESP_LOGW(TAG, "YNega configured: %d cm", y_min); }));
+  this->command_queue_.enqueue(Command::YMinCommand(y_min), millis());
 }
 
 void LD6001AComponent::config_y_max(int y_max) {
   ESP_LOGW(TAG, "Configurting YPosi: %d cm", y_max);
-
-  this->command_queue_.enqueue(Command::YMaxCommand(
-      y_max, [this, y_max](const std::string &response) { ESP_LOGW(TAG, "YPosi configured: %d cm", y_max); }));
+  this->command_queue_.enqueue(Command::YMaxCommand(y_max), millis());
 }
 
 void LD6001AComponent::config_moving_target_disappearance_time(uint32_t time_ms) {
   ESP_LOGD(TAG, "Configuring moving target disappearance time: %d ms", time_ms);
-
-  this->command_queue_.enqueue(
-      Command::SetMovingTargetDisappearanceTimeCommand(time_ms, [this, time_ms](const std::string &response) {
-        ESP_LOGD(TAG, "Moving target disappearance time configured: %d ms", time_ms);
-      }));
+  this->command_queue_.enqueue(Command::SetMovingTargetDisappearanceTimeCommand(time_ms), millis());
 }
 
 void LD6001AComponent::config_static_target_disappearance_time(uint32_t time_ms) {
   ESP_LOGW(TAG, "Configuring static target disappearance time: %d ms", time_ms);
-  this->command_queue_.enqueue(
-      Command::SetStaticTargetDisappearanceTimeCommand(time_ms, [this, time_ms](const std::string &response) {
-        ESP_LOGW(TAG, "Static target disappearance time configured: %d ms", time_ms);
-      }));
+  this->command_queue_.enqueue(Command::SetStaticTargetDisappearanceTimeCommand(time_ms), millis());
 }
 
 void LD6001AComponent::config_exit_boundary_time(uint32_t time_ms) {
@@ -200,13 +285,232 @@ void LD6001AComponent::config_exit_boundary_time(uint32_t time_ms) {
   assert(time_ms >= 200 && time_ms <= 1000 * 100);
 
   ESP_LOGW(TAG, "Configuring exit boundary time: %d ms", time_ms);
-  this->command_queue_.enqueue(
-      Command::TargetExitBoundaryTimeCommand(time_ms, [this, time_ms](const std::string &response) {
-        ESP_LOGW(TAG, "Exit boundary time configured: %d ms", time_ms);
-      }));
+  this->command_queue_.enqueue(Command::TargetExitBoundaryTimeCommand(time_ms), millis());
+}
+
+void LD6001AComponent::send_command(const Command &command) { this->write_str(command.c_str()); }
+
+void LD6001AComponent::on_command_done(const Command &command) {
+  if (command.is_write() && this->sync_state_ == SyncState::DONE) {
+    this->set_synced_(false);  // Changed at runtime, compared again on the next boot
+  }
+
+  switch (command.type) {
+    case CommandType::START:
+      ESP_LOGW(TAG, "HLK-LD6001A started");
+      break;
+    case CommandType::STOP:
+      ESP_LOGW(TAG, "HLK-LD6001A stopped");
+      break;
+    case CommandType::RESET:
+      ESP_LOGD(TAG, "HLK-LD6001A reset");
+      break;
+    case CommandType::RESTORE:
+      ESP_LOGW(TAG, "Factory settings configured");
+      this->command_queue_.enqueue(Command::ReadCommand(), millis());
+      break;
+    case CommandType::PROTOCOL_MODE:
+      ESP_LOGD(TAG, "Protocol mode set to %d", command.value);
+      break;
+    case CommandType::RANGE_SENSITIVITY:
+      ESP_LOGW(TAG, "Distance sensitivity configured: %d", command.value);
+      break;
+    case CommandType::HEARTBEAT_INTERVAL:
+      ESP_LOGW(TAG, "Heart beat interval configured: %d s", command.value);
+      break;
+    case CommandType::INSTALLATION_HEIGHT:
+      ESP_LOGW(TAG, "Vertical distance configured: %d cm", command.value);
+      break;
+    case CommandType::RANGE:
+      ESP_LOGW(TAG, "Ground radius configured: %d cm", command.value);
+      break;
+    case CommandType::X_MIN:
+      ESP_LOGW(TAG, "XNega configured: %d cm", command.value);
+      break;
+    case CommandType::X_MAX:
+      ESP_LOGW(TAG, "XPosi configured: %d cm", command.value);
+      break;
+    case CommandType::Y_MIN:
+      ESP_LOGW(TAG, "YNega configured: %d cm", command.value);
+      break;
+    case CommandType::Y_MAX:
+      ESP_LOGW(TAG, "YPosi configured: %d cm", command.value);
+      break;
+    case CommandType::MOVING_TARGET_DISAPPEARANCE_TIME:
+      ESP_LOGD(TAG, "Moving target disappearance time configured: %d ms", command.value);
+      break;
+    case CommandType::STATIC_TARGET_DISAPPEARANCE_TIME:
+      ESP_LOGW(TAG, "Static target disappearance time configured: %d ms", command.value);
+      break;
+    case CommandType::EXIT_BOUNDARY_TIME:
+      ESP_LOGW(TAG, "Exit boundary time configured: %d ms", command.value);
+      break;
+    case CommandType::READ:
+      break;
+  }
 }
 
-void LD6001AComponent::on_ack_response() { this->command_queue_.handleResponse(""); };
+void LD6001AComponent::on_command_failed(const Command &command) {
+  if (command.type != CommandType::READ || this->sync_state_ == SyncState::DONE) {
+    return;
+  }
+
+  if (this->sync_state_ == SyncState::READING && !this->sync_reset_) {
+    ESP_LOGW(TAG, "No parameters from HLK-LD6001A, resetting it");
+    this->sync_reset_ = true;
+    this->command_queue_.enqueue(Command::ResetCommand(), millis());
+    this->command_queue_.enqueue(Command::ReadCommand(), millis());
+    return;
+  }
+
+  ESP_LOGE(TAG, "No parameters from HLK-LD6001A, starting it as it is");
+  this->sync_state_ = SyncState::DONE;
+  this->set_synced_(false);
+  this->set_protocol_mode(ProtocolMode::PROTOCOL_MODE_DETAILED);
+  if (!this->command_queue_.is_running()) {
+    this->start();
+  }
+}
+
+void LD6001AComponent::sync_parameters_(const ReadParamsResponse &params) {
+  switch (this->sync_state_) {
+    case SyncState::READING: {
+      bool mode_differs = params.protocol_mode != ProtocolMode::PROTOCOL_MODE_DETAILED;
+      size_t writes = this->config_sync_.diff(params, [](const Command &command) {});
+      if (writes == 0 && !mode_differs) {
+        ESP_LOGI(TAG, "Parameters in sync");
+        this->sync_state_ = SyncState::DONE;
+        this->set_synced_(true);
+        this->start();
+        break;
+      }
+
+      // Stopped first, the radar may still run from before the reboot. The writes are followed by a READ, the protocol
+      // mode alone is read back explicitly.
+      ESP_LOGI(TAG, "Writing %u parameters that differ%s", writes, mode_differs ? " and the protocol mode" : "");
+      this->sync_state_ = SyncState::WRITING;
+      this->stop();
+      if (mode_differs) {
+        this->set_protocol_mode(ProtocolMode::PROTOCOL_MODE_DETAILED);
+      }
+      if (writes == 0) {
+        this->command_queue_.enqueue(Command::ReadCommand(), millis());
+      }
+      this->config_sync_.diff(params,
+                              [this](const Command &command) { this->command_queue_.enqueue(command, millis()); });
+      break;
+    }
+
+    case SyncState::WRITING: {
+      size_t differing = this->config_sync_.diff(params, [](const Command &command) {
+        ESP_LOGW(TAG, "HLK-LD6001A did not take %s", command.c_str());
+      });
+      bool mode_taken = params.protocol_mode == ProtocolMode::PROTOCOL_MODE_DETAILED;
+      if (!mode_taken) {
+        ESP_LOGW(TAG, "HLK-LD6001A did not take protocol mode %d", ProtocolMode::PROTOCOL_MODE_DETAILED);
+      }
+      this->sync_state_ = SyncState::DONE;
+      this->set_synced_(differing == 0 && mode_taken);
+      if (!this->command_queue_.is_running()) {
+        this->start();
+      }
+      break;
+    }
+
+    case SyncState::VERIFYING:
+      // Started right away, the parameters were in sync on an earlier boot. Only the protocol mode is checked, it is
+      // what makes the radar send detailed frames.
+      if (params.protocol_mode == ProtocolMode::PROTOCOL_MODE_DETAILED) {
+        this->sync_state_ = SyncState::DONE;
+        this->set_synced_(true);
+        break;
+      }
+
+      ESP_LOGW(TAG, "HLK-LD6001A is in protocol mode %d, setting it again", params.protocol_mode);
+      this->sync_state_ = SyncState::WRITING;
+      this->set_synced_(false);
+      this->set_protocol_mode(ProtocolMode::PROTOCOL_MODE_DETAILED);
+      this->command_queue_.enqueue(Command::ReadCommand(), millis());
+      break;
+
+    case SyncState::DONE:
+      break;
+  }
+}
+
+void LD6001AComponent::set_synced_(bool synced) {
+#ifdef USE_LD6001A_WARM_START
+  this->warm_start_.state.synced = synced;
+#endif
+}
+
+#ifdef USE_LD6001A_WARM_START
+bool LD6001AComponent::restore_warm_state_() {
+  Fingerprint fingerprint;
+  fingerprint.add(this->config_sync_);
+  for (size_t i = 0; i < this->zones_.size(); i++) {
+    if (this->zones_.is_polygon(i)) {
+      auto bounds = this->zones_.get_bounds(i);
+      fingerprint.add(i).add(this->zones_.get_vertex_count(i)).add(bounds.x1).add(bounds.y1).add(bounds.x2).add(
+          bounds.y2);
+    }
+  }
+
+  uint32_t hash = fnv1_hash(App.get_friendly_name() + "_ld6001a_warm_start");
+  this->warm_pref_ = global_preferences->make_preference<WarmState<ZoneEngine::CAPACITY>>(hash, true);
+
+  WarmState<ZoneEngine::CAPACITY> saved;
+  if (!this->warm_pref_.load(&saved)) {
+    saved = {};
+  }
+  if (!this->warm_start_.restore(saved, fingerprint.get())) {
+    ESP_LOGI(TAG, "Cold start, no state saved for this configuration");
+    return false;
+  }
+
+  const auto &state = this->warm_start_.state;
+  ESP_LOGI(TAG, "Warm start with %u targets", state.target_count);
+
+  // Published right away, the first radar frame replaces it
+  this->people_counted_ = state.target_count;
+#ifdef USE_SENSOR
+  maybe_publish(this->target_count_sensor_, state.target_count);
+  for (size_t i = 0; i < this->zone_target_count_sensors_.size(); i++) {
+    maybe_publish(this->zone_target_count_sensors_[i], state.zone_counts[i]);
+  }
+#endif
+  this->zones_changed_ = ~ZoneEngine::mask_type(0);  // Zones the first frame leaves at 0 are published as well
+  this->warm_hold_ = true;
+
+  return state.synced;
+}
+
+void LD6001AComponent::save_warm_state_(bool force) {
+  auto &state = this->warm_start_.state;
+  state.target_count = this->people_counted_;
+  for (size_t i = 0; i < this->zones_.size(); i++) {
+    state.zone_counts[i] = this->zones_.get_count(i);
+  }
+
+  uint32_t now = millis();
+  if (this->warm_start_.should_save(now, force)) {
+    ESP_LOGV(TAG, "Saving warm state");
+    this->warm_pref_.save(&state);
+    this->warm_start_.mark_saved(now);
+  }
+}
+#endif
+
+void LD6001AComponent::on_shutdown() {
+#ifdef USE_LD6001A_WARM_START
+  // Before an OTA update or reboot, so the next boot starts from the latest state
+  this->save_warm_state_(true);
+#endif
+}
+
+void LD6001AComponent::on_at_reply(const char *reply) { this->command_queue_.handle_reply(reply, millis()); }
+
+void LD6001AComponent::on_save_param_failed() { ESP_LOGE(TAG, "HLK-LD6001A failed to save its parameters"); }
 
 void LD6001AComponent::on_read_params_response(const ReadParamsResponse response) {
   ESP_LOGW(TAG, "READ response: Target Exit Time %f seconds", response.target_exit_time);
@@ -222,32 +526,98 @@ void LD6001AComponent::on_read_params_response(const ReadParamsResponse response
   maybe_publish(this->x_max_number_, response.x_posi);
   maybe_publish(this->y_min_number_, response.y_nega);
   maybe_publish(this->y_max_number_, response.y_posi);
+
+  this->sync_parameters_(response);
 };
 
 void LD6001AComponent::on_simple_radar_response(const uint8_t people_counted) {
   this->people_counted_ = people_counted;
+  this->mark_frame_pending_();
   ESP_LOGV(TAG, "Simple radar response: %d people detected", people_counted);
 }
 
-void LD6001AComponent::on_detailed_radar_response(const std::vector<Person> people) {
-  this->detailed_people_response_ = people;
+void LD6001AComponent::on_detailed_radar_response(Span<Person> people) {
+  std::copy(people.begin(), people.end(), this->detailed_people_response_.begin());
+  this->detailed_people_count_ = people.size();
   this->people_counted_ = people.size();
+  this->mark_frame_pending_();
   ESP_LOGV(TAG, "Detailed radar response: %d people detected", this->people_counted_);
-  this->target_tracker_.update(people);
+
+  // Sensors, zones and triggers all work on the smoothed positions
+  uint32_t now = millis();
+  this->target_tracker_.update(this->get_targets(), now);
+  this->target_tracker_.smooth(this->detailed_people_response_.begin(),
+                               this->detailed_people_response_.begin() + this->detailed_people_count_, now);
+
+  // Zones are followed on every frame so enter and leave events are not held back by the throttle
+  std::array<ZoneEngine::mask_type, MAX_TARGETS> target_zones;
+  this->zones_changed_ |= this->zones_.update(this->get_targets(), target_zones.data());
+  this->zone_occupancy_.update(this->get_targets(), target_zones.data(), now);
+
+#ifdef USE_LD6001A_HEATMAP
+  for (const auto &person : this->get_targets()) {
+    this->heatmap_.add(person.x * 100, person.y * 100);
+  }
+#endif
+}
+
+#ifdef USE_LD6001A_HEATMAP
+void LD6001AComponent::set_heatmap(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t cell_size,
+                                   uint32_t decay_interval, float decay_factor) {
+  if (!this->heatmap_.configure(x1, y1, x2, y2, cell_size)) {
+    ESP_LOGE(TAG, "Heatmap: invalid area (%d, %d) (%d, %d) for cells of %u cm", x1, y1, x2, y2, cell_size);
+  }
+  this->heatmap_decay_interval_ = decay_interval;
+  this->heatmap_decay_factor_ = decay_factor;
+}
+
+void LD6001AComponent::export_heatmap() { this->heatmap_trigger_.trigger(this->heatmap_.encode()); }
+#endif
+
+void LD6001AComponent::set_zone_polygon(uint8_t zone, std::initializer_list<ZoneVertex> vertices) {
+  if (!this->zones_.set_polygon(zone, vertices)) {
+    ESP_LOGE(TAG, "Zone %d: invalid polygon of %u vertices", zone + 1, vertices.size());
+  }
 }
 
 void LD6001AComponent::on_invalid_frame() { ESP_LOGE(TAG, "Invalid frame received"); }
 
+void LD6001AComponent::mark_frame_pending_() {
+  this->last_frame_millis_ = millis();
+
+  // The first frame after a publish schedules the next one, later frames only update the state it publishes
+  if (this->event_driven_ && !this->frame_pending_) {
+    this->set_timeout("publish", this->coalesce_window_, [this]() { this->publish_sensors_(millis()); });
+  }
+  this->frame_pending_ = true;
+}
+
 void LD6001AComponent::update_sensors_() {
   /*
       Reduce data update rate to prevent home assistant database size grow fast
     */
-  int32_t current_millis = millis();
+  uint32_t current_millis = millis();
   if (current_millis - last_periodic_millis_ < this->throttle_) {
     return;
   }
 
+#ifdef USE_LD6001A_WARM_START
+  // The restored state stays until the radar reports, unless it does not for too long
+  if (this->warm_hold_ && !this->frame_pending_ && current_millis < WARM_STATE_HOLD_TIME) {
+    return;
+  }
+  this->warm_hold_ = false;
+#endif
+
   last_periodic_millis_ = current_millis;
+  this->publish_sensors_(current_millis);
+}
+
+void LD6001AComponent::publish_sensors_(uint32_t current_millis) {
+  if (this->frame_pending_) {
+    this->publish_latency_ms_ = current_millis - this->last_frame_millis_;
+    this->frame_pending_ = false;
+  }
 
   maybe_publish(this->target_count_sensor_, this->people_counted_);
 
@@ -258,38 +628,72 @@ void LD6001AComponent::update_sensors_() {
     float z = NAN;
     float distance = NAN;
 
-    if (i < people_counted_) {
-      auto person = this->detailed_people_response_[i];
+    if (i < this->detailed_people_count_) {
+      const auto &person = this->detailed_people_response_[i];
       x = person.x * 100;
       y = person.y * 100;
       z = person.z * 100;
       distance = sqrt(x * x + y * y + z * z);
     }
 
-    maybe_publish(this->move_x_sensors_[i], x);
-    maybe_publish(this->move_y_sensors_[i], y);
-    maybe_publish(this->move_z_sensors_[i], z);
-    maybe_publish(this->move_distance_sensors_[i], distance);
+    this->move_x_sensors_[i].publish(x, current_millis);
+    this->move_y_sensors_[i].publish(y, current_millis);
+    this->move_z_sensors_[i].publish(z, current_millis);
+    this->move_distance_sensors_[i].publish(distance, current_millis);
   }
 
-  for (size_t index = 0; index < MAX_ZONES; ++index) {
-    auto &zone = this->zone_config_[index];
-    zone.target_count = 0;
-
-    for (const auto &person : this->detailed_people_response_) {
-      auto target_id = person.id;
-      auto coord_x = person.x;
-      auto coord_y = person.y;
-
-      if (zone.contains(coord_x * 100, coord_y * 100)) {
-        zone.target_count++;
-      }
+  // Only zones whose count changed are published
+  for (; this->zones_changed_ != 0; this->zones_changed_ &= this->zones_changed_ - 1) {
+    size_t index = __builtin_ctzll(this->zones_changed_);
+    if (index < this->zone_target_count_sensors_.size()) {
+      maybe_publish(this->zone_target_count_sensors_[index], this->zones_.get_count(index));
     }
-    maybe_publish(this->zone_target_count_sensors_[index], zone.target_count);
+  }
+  for (size_t i = 0; i < this->zone_dwell_time_sensors_.size(); i++) {
+    maybe_publish(this->zone_dwell_time_sensors_[i], this->zone_occupancy_.get_dwell_time(i, current_millis) / 1000);
   }
 
-  this->update_trigger_.trigger(this->detailed_people_response_);
+  this->update_trigger_.trigger(this->get_targets());
+
+#ifdef USE_LD6001A_WARM_START
+  this->save_warm_state_(false);
+#endif
+
+#ifdef USE_LD6001A_SNAPSHOT
+  // Handed over in place, the encoder buffer stays valid until the next publish
+  this->snapshot_trigger_.trigger(this->snapshot_encoder_.encode(current_millis, this->get_targets()));
+#endif
+}
+
+#ifdef USE_SENSOR
+void LD6001AComponent::publish_diagnostics_() {
+  const auto &stats = this->get_parser_stats();
+  uint32_t now = millis();
+  uint32_t frames = stats.get_total_frames();
+
+  if (now != this->last_diagnostics_millis_) {
+    maybe_publish(this->frame_rate_sensor_,
+                  (frames - this->last_diagnostics_frames_) * 1000.0f / (now - this->last_diagnostics_millis_));
+  }
+  this->last_diagnostics_frames_ = frames;
+  this->last_diagnostics_millis_ = now;
+
+  maybe_publish(this->radar_frames_sensor_,
+                stats.get_frames(FrameType::DETAILED_RADAR) + stats.get_frames(FrameType::SIMPLE_RADAR));
+  maybe_publish(this->bytes_discarded_sensor_, stats.bytes_discarded);
+  maybe_publish(this->checksum_failures_sensor_, stats.checksum_failures);
+  maybe_publish(this->buffer_overflows_sensor_, stats.buffer_overflows);
+  maybe_publish(this->command_retries_sensor_, this->get_command_stats().retries);
+  maybe_publish(this->command_failures_sensor_, this->get_command_stats().failures);
+
+  // Ingest times are per interval, so a single slow loop shows up once instead of forever
+  auto ingest = this->ingest_stats_.take();
+  maybe_publish(this->ingest_time_max_sensor_, ingest.count > 0 ? ingest.max_us : NAN);
+  maybe_publish(this->ingest_time_avg_sensor_, ingest.get_average_us());
+
+  maybe_publish(this->publish_latency_sensor_, this->publish_latency_ms_);
 }
+#endif
 
 void LD6001AComponent::on_target_enter(uint32_t target_id) {
   ESP_LOGW(TAG, "Target %d entered view", target_id);
@@ -301,15 +705,50 @@ void LD6001AComponent::on_target_left(uint32_t target_id, uint32_t dwell_time) {
   this->target_left_trigger_.trigger(target_id, dwell_time);
 }
 
+void LD6001AComponent::on_zone_enter(uint8_t zone, uint32_t target_id) {
+  ESP_LOGD(TAG, "Target %d entered zone %d", target_id, zone + 1);
+  this->zone_enter_trigger_.trigger(zone + 1, target_id);
+}
+
+void LD6001AComponent::on_zone_left(uint8_t zone, uint32_t target_id, uint32_t dwell_time) {
+  ESP_LOGD(TAG, "Target %d left zone %d, dwell time: %d seconds", target_id, zone + 1, dwell_time);
+  this->zone_left_trigger_.trigger(zone + 1, target_id, dwell_time);
+}
+
 #ifdef USE_SENSOR
-void LD6001AComponent::set_move_x_sensor(uint8_t target, sensor::Sensor *s) { this->move_x_sensors_[target] = s; }
-void LD6001AComponent::set_move_y_sensor(uint8_t target, sensor::Sensor *s) { this->move_y_sensors_[target] = s; }
-void LD6001AComponent::set_move_z_sensor(uint8_t target, sensor::Sensor *s) { this->move_z_sensors_[target] = s; }
-void LD6001AComponent::set_move_distance_sensor(uint8_t zone, sensor::Sensor *s) {
-  this->move_distance_sensors_[zone] = s;
+void LD6001AComponent::set_move_x_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                         uint32_t max_interval) {
+  this->move_x_sensors_[target].sensor = s;
+  this->move_x_sensors_[target].filter.configure(min_delta, max_interval);
+}
+void LD6001AComponent::set_move_y_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                         uint32_t max_interval) {
+  this->move_y_sensors_[target].sensor = s;
+  this->move_y_sensors_[target].filter.configure(min_delta, max_interval);
+}
+void LD6001AComponent::set_move_z_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                         uint32_t max_interval) {
+  this->move_z_sensors_[target].sensor = s;
+  this->move_z_sensors_[target].filter.configure(min_delta, max_interval);
+}
+void LD6001AComponent::set_move_distance_sensor(uint8_t target, sensor::Sensor *s, float min_delta,
+                                                uint32_t max_interval) {
+  this->move_distance_sensors_[target].sensor = s;
+  this->move_distance_sensors_[target].filter.configure(min_delta, max_interval);
 }
 void LD6001AComponent::set_zone_target_count_sensor(uint8_t zone, sensor::Sensor *s) {
+  if (zone >= this->zone_target_count_sensors_.size()) {
+    this->zone_target_count_sensors_.resize(zone + 1, nullptr);
+  }
   this->zone_target_count_sensors_[zone] = s;
+  this->zones_.ensure_size(zone + 1);
+}
+void LD6001AComponent::set_zone_dwell_time_sensor(uint8_t zone, sensor::Sensor *s) {
+  if (zone >= this->zone_dwell_time_sensors_.size()) {
+    this->zone_dwell_time_sensors_.resize(zone + 1, nullptr);
+  }
+  this->zone_dwell_time_sensors_[zone] = s;
+  this->zones_.ensure_size(zone + 1);
 }
 #endif
 
@@ -323,31 +762,32 @@ void LD6001AComponent::set_zone_coordinate(uint8_t zone) {
     return;
   }
 
+  if (this->zones_.is_polygon(zone)) {
+    ESP_LOGW(TAG, "Zone %d is a polygon, ignoring its coordinate numbers", zone);
+    return;
+  }
+
   ESP_LOGW(TAG, "Set new coordinates for zone %d: (%d, %d) (%d, %d)", zone, static_cast<int>(x1sens->state),
            static_cast<int>(y1sens->state), static_cast<int>(x2sens->state), static_cast<int>(y2sens->state));
 
-  this->zone_config_[zone].x1 = static_cast<int>(x1sens->state);
-  this->zone_config_[zone].y1 = static_cast<int>(y1sens->state);
-  this->zone_config_[zone].x2 = static_cast<int>(x2sens->state);
-  this->zone_config_[zone].y2 = static_cast<int>(y2sens->state);
+  this->zones_.set_rectangle(zone, static_cast<int>(x1sens->state), static_cast<int>(y1sens->state),
+                             static_cast<int>(x2sens->state), static_cast<int>(y2sens->state));
 
-  ZoneCoordinates zones[MAX_ZONES];
-  for (size_t i = 0; i < MAX_ZONES; i++) {
-    zones[i].x1 = this->zone_config_[i].x1;
-    zones[i].y1 = this->zone_config_[i].y1;
-    zones[i].x2 = this->zone_config_[i].x2;
-    zones[i].y2 = this->zone_config_[i].y2;
+  ZoneCoordinates zones[MAX_NUMBER_ZONES];
+  for (size_t i = 0; i < MAX_NUMBER_ZONES && i < this->zones_.size(); i++) {
+    zones[i] = this->zones_.get_bounds(i);
   }
   this->pref_.save(&zones);
 }
 
 void LD6001AComponent::set_zone_numbers(uint8_t zone, number::Number *x1, number::Number *y1, number::Number *x2,
                                        number::Number *y2) {
-  if (zone < MAX_ZONES) {
+  if (zone < MAX_NUMBER_ZONES) {
     this->zone_numbers_[zone].x1 = x1;
     this->zone_numbers_[zone].y1 = y1;
     this->zone_numbers_[zone].x2 = x2;
     this->zone_numbers_[zone].y2 = y2;
+    this->zones_.ensure_size(zone + 1);
   }
 }
 #endif
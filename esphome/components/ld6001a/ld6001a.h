@@ -11,9 +11,23 @@
 #include "esphome/core/preferences.h"
 #include "frame_parser.h"
 #include "command_queue.h"
+#include "config_sync.h"
 #include "target_tracker.h"
+#include "zone_engine.h"
+#include "zone_occupancy.h"
+#include "capture.h"
+#include "snapshot.h"
+#include "heatmap.h"
+#include "publish_filter.h"
+#include "warm_start.h"
 #include "esphome/core/application.h"
 
+#ifdef USE_LD6001A_PARSER_TASK
+#include "frame_event_queue.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
 #ifdef USE_SENSOR
 #include "esphome/components/sensor/sensor.h"
 #endif
@@ -22,28 +36,40 @@
 #include "esphome/components/number/number.h"
 #endif
 
-#define MAX_TARGETS 10
-
 namespace esphome {
 namespace ld6001a {
 
-static const uint8_t MAX_ZONES = 4;
-
-struct ZoneCoordinates {
-  int16_t x1 = 0;
-  int16_t y1 = 0;
-  int16_t x2 = 0;
-  int16_t y2 = 0;
+static const uint8_t MAX_NUMBER_ZONES = 4;  // Zones whose rectangle can be set through number entities
+static const size_t UART_CHUNK_SIZE = 128;  // Max bytes read from the UART in one go
+static const size_t PARSER_TASK_QUEUE_SIZE = 8;     // Parsed frames buffered between the parser task and loop()
+static const uint32_t PARSER_TASK_STACK_SIZE = 4096;
+static const size_t CAPTURE_BUFFER_SIZE = 512;      // UART capture bytes handed to on_capture at once
+static const uint32_t CAPTURE_FLUSH_INTERVAL = 1000;  // Max ms a captured read waits in the buffer
+static const uint32_t DIAGNOSTICS_INTERVAL = 10000;   // Publish interval of the link health sensors
+static const uint32_t WARM_STATE_HOLD_TIME = 30000;   // Max ms the restored state is kept while no frame arrives
+static const uint16_t BOOT_READ_TIMEOUT = 500;        // ms to wait for the first AT+READ, sent twice before a reset
+
+// Boot time sync of the radar parameters, see setup()
+enum class SyncState : uint8_t {
+  READING,    // Waiting for the parameters the radar has
+  WRITING,    // Waiting for the READ after writing the parameters or protocol mode that differed
+  VERIFYING,  // Warm start, waiting for the READ that confirms the protocol mode
+  DONE,
 };
 
-// Zone coordinate struct
-struct Zone: ZoneCoordinates {
-  uint8_t target_count = 0;
-
-  bool contains(const int16_t x, const int16_t y) const {
-    return (x >= this->x1 && x <= this->x2 && y >= this->y1 && y <= this->y2);
+#ifdef USE_SENSOR
+// Per target sensor together with the state that decides which of its values are published
+struct FilteredSensor {
+  sensor::Sensor *sensor = nullptr;
+  PublishFilter filter;
+
+  void publish(float value, uint32_t now) {
+    if (this->sensor != nullptr && this->filter.update(value, now)) {
+      this->sensor->publish_state(value);
+    }
   }
 };
+#endif
 
 #ifdef USE_NUMBER
 struct ZoneOfNumbers {
@@ -54,9 +80,21 @@ struct ZoneOfNumbers {
 };
 #endif
 
-class LD6001AComponent : public Component, public uart::UARTDevice, public FrameHandler, protected TargetEventHandler<uint32_t> {
+class LD6001AComponent : public Component, public uart::UARTDevice, public FrameHandler, protected TargetEventHandler<uint32_t>,
+                         protected ZoneEventHandler<uint32_t>, protected CommandHandler {
 #ifdef USE_SENSOR
   SUB_SENSOR(target_count)
+
+  SUB_SENSOR(frame_rate)
+  SUB_SENSOR(radar_frames)
+  SUB_SENSOR(bytes_discarded)
+  SUB_SENSOR(checksum_failures)
+  SUB_SENSOR(buffer_overflows)
+  SUB_SENSOR(command_retries)
+  SUB_SENSOR(command_failures)
+  SUB_SENSOR(ingest_time_max)
+  SUB_SENSOR(ingest_time_avg)
+  SUB_SENSOR(publish_latency)
 #endif
 
 #ifdef USE_NUMBER
@@ -79,21 +117,63 @@ class LD6001AComponent : public Component, public uart::UARTDevice, public Frame
   void setup() override;
   void dump_config() override;
   void loop() override;
+  void on_shutdown() override;
 
   void start();
   void stop();
   void reset();
   void soft_reset();
 
-  const std::vector<Person> &get_targets() const { return this->detailed_people_response_; }
+  Span<Person> get_targets() const {
+    return Span<Person>(this->detailed_people_response_.data(), this->detailed_people_count_);
+  }
 
   Trigger<uint32_t> *get_target_enter_trigger() { return &this->target_enter_trigger_; }
   Trigger<uint32_t, uint32_t> *get_target_left_trigger() { return &this->target_left_trigger_; }
-  Trigger<const std::vector<Person> &> *get_update_trigger() { return &this->update_trigger_; }
+  Trigger<uint8_t, uint32_t> *get_zone_enter_trigger() { return &this->zone_enter_trigger_; }
+  Trigger<uint8_t, uint32_t, uint32_t> *get_zone_left_trigger() { return &this->zone_left_trigger_; }
+  Trigger<Span<Person>> *get_update_trigger() { return &this->update_trigger_; }
+  Trigger<std::vector<uint8_t>> *get_capture_trigger() { return &this->capture_trigger_; }
+  Trigger<Span<uint8_t>> *get_snapshot_trigger() { return &this->snapshot_trigger_; }
+  Trigger<std::vector<uint8_t>> *get_heatmap_trigger() { return &this->heatmap_trigger_; }
 
   void set_protocol_mode(ProtocolMode mode);
   void set_throttle(uint16_t value) { this->throttle_ = value; };
+  // Publishes once per radar frame instead of polling, frames within the window are published together
+  void set_coalesce_window(uint32_t window) {
+    this->event_driven_ = true;
+    this->coalesce_window_ = window;
+  }
   void set_reset_pin(InternalGPIOPin *reset_pin) { this->reset_pin_ = reset_pin; }
+  void set_parser_task(bool parser_task) { this->parser_task_ = parser_task; }
+  void set_smoothing(float alpha, float beta) { this->target_tracker_.set_smoothing(alpha, beta); }
+  void set_zone_polygon(uint8_t zone, std::initializer_list<ZoneVertex> vertices);
+  // Parameter the radar is configured with on boot, value in the units of the matching config_*() call
+  void set_parameter(CommandType type, int32_t value) { this->config_sync_.set(type, value); }
+
+  // Seconds the zone has been occupied without interruption, 0 while it is empty
+  uint32_t get_zone_dwell_time(uint8_t zone) const { return this->zone_occupancy_.get_dwell_time(zone, millis()) / 1000; }
+  // Seconds the zone has been occupied in total since boot
+  uint32_t get_zone_occupied_time(uint8_t zone) const {
+    return this->zone_occupancy_.get_total_time(zone, millis()) / 1000;
+  }
+
+#ifdef USE_LD6001A_WARM_START
+  // Keeps the occupancy in flash to publish it right after a reboot, saved at most every save_interval ms
+  void set_warm_start(uint32_t save_interval) { this->warm_start_.set_interval(save_interval); }
+#endif
+
+#ifdef USE_LD6001A_HEATMAP
+  // Area and cell size in cm, decay_factor is applied every decay_interval ms, 0 never decays
+  void set_heatmap(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t cell_size, uint32_t decay_interval,
+                   float decay_factor);
+  // Hands the heatmap to on_export, e.g. from a button or API service
+  void export_heatmap();
+  void clear_heatmap() { this->heatmap_.clear(); }
+#endif
+
+  const ParserStats &get_parser_stats() const { return this->frame_parser_.get_stats(); }
+  const CommandStats &get_command_stats() const { return this->command_queue_.get_stats(); }
 
 #ifdef USE_NUMBER
   void set_zone_coordinate(uint8_t zone);
@@ -115,53 +195,125 @@ class LD6001AComponent : public Component, public uart::UARTDevice, public Frame
   void config_static_target_disappearance_time(uint32_t time_ms);
   void config_exit_boundary_time(uint32_t time_ms);
 
-  void on_ack_response() override;
+  void on_at_reply(const char *reply) override;
+  void on_save_param_failed() override;
   void on_read_params_response(const ReadParamsResponse response) override;
   void on_simple_radar_response(const uint8_t people_counted);
-  void on_detailed_radar_response(const std::vector<Person> people);
+  void on_detailed_radar_response(Span<Person> people) override;
   void on_invalid_frame() override;
 
   virtual void on_target_enter(uint32_t target_id) override;
   virtual void on_target_left(uint32_t target_id, uint32_t dwell_time) override;
+  virtual void on_zone_enter(uint8_t zone, uint32_t target_id) override;
+  virtual void on_zone_left(uint8_t zone, uint32_t target_id, uint32_t dwell_time) override;
 
 #ifdef USE_SENSOR
-  void set_move_x_sensor(uint8_t target, sensor::Sensor *s);
-  void set_move_y_sensor(uint8_t target, sensor::Sensor *s);
-  void set_move_z_sensor(uint8_t target, sensor::Sensor *s);
-  void set_move_distance_sensor(uint8_t target, sensor::Sensor *s);
+  void set_move_x_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
+  void set_move_y_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
+  void set_move_z_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
+  void set_move_distance_sensor(uint8_t target, sensor::Sensor *s, float min_delta = 0, uint32_t max_interval = 0);
   void set_zone_target_count_sensor(uint8_t zone, sensor::Sensor *s);
+  void set_zone_dwell_time_sensor(uint8_t zone, sensor::Sensor *s);
 #endif
 
  protected:
   FrameParser frame_parser_{*this};
-  CommandQueue command_queue_{[this](const std::string &cmd) { this->write_str(cmd.c_str()); }};
+  CommandQueue command_queue_{*this};
+  ConfigSync config_sync_;
+  SyncState sync_state_ = SyncState::DONE;
+  bool sync_reset_ = false;  // The radar was reset because it did not answer the first READ
 
-  std::vector<Person> detailed_people_response_{};
+  std::array<Person, MAX_TARGETS> detailed_people_response_{};
+  uint8_t detailed_people_count_ = 0;
   uint8_t people_counted_ = 0;
   uint16_t throttle_ = 1000;
-  uint16_t last_periodic_millis_ = 0;
+  uint32_t last_periodic_millis_ = 0;
+  bool event_driven_ = false;
+  uint32_t coalesce_window_ = 0;
+
+  void send_command(const Command &command) override;
+  void on_command_done(const Command &command) override;
+  void on_command_failed(const Command &command) override;
+  void sync_parameters_(const ReadParamsResponse &params);
+  void set_synced_(bool synced);
+#ifdef USE_LD6001A_WARM_START
+  bool restore_warm_state_();
+  void save_warm_state_(bool force);
+#endif
 
   void update_sensors_();
+  void publish_sensors_(uint32_t now);
+  void mark_frame_pending_();
+  void read_uart_();
+#ifdef USE_SENSOR
+  void publish_diagnostics_();
+#endif
+
+  IngestStats ingest_stats_;
+  uint32_t last_frame_millis_ = 0;    // When the last radar frame arrived
+  uint32_t publish_latency_ms_ = 0;   // Age of the last radar frame when the sensors were last published
+  bool frame_pending_ = false;        // A radar frame arrived since the sensors were last published
+  uint32_t last_diagnostics_frames_ = 0;
+  uint32_t last_diagnostics_millis_ = 0;
+
+  bool parser_task_ = false;
+#ifdef USE_LD6001A_PARSER_TASK
+  static void parser_task_loop_(void *param);
+
+  FrameEventQueue<PARSER_TASK_QUEUE_SIZE> frame_events_;
+  TaskHandle_t parser_task_handle_ = nullptr;
+#endif
 
   TargetTracker<Person> target_tracker_{*this};
   Trigger<uint32_t> target_enter_trigger_;
   Trigger<uint32_t, uint32_t> target_left_trigger_;
-  Trigger<const std::vector<Person> &> update_trigger_;
+  Trigger<uint8_t, uint32_t> zone_enter_trigger_;
+  Trigger<uint8_t, uint32_t, uint32_t> zone_left_trigger_;
+  Trigger<Span<Person>> update_trigger_;
+  Trigger<std::vector<uint8_t>> capture_trigger_;
+
+#ifdef USE_LD6001A_CAPTURE
+  CaptureRecorder<CAPTURE_BUFFER_SIZE> capture_recorder_{[this](const uint8_t *data, size_t len) {
+    this->capture_trigger_.trigger(std::vector<uint8_t>(data, data + len));
+  }};
+  uint32_t last_capture_flush_millis_ = 0;
+#endif
+
+  Trigger<Span<uint8_t>> snapshot_trigger_;
+#ifdef USE_LD6001A_SNAPSHOT
+  SnapshotEncoder snapshot_encoder_;
+#endif
+
+  Trigger<std::vector<uint8_t>> heatmap_trigger_;
+#ifdef USE_LD6001A_HEATMAP
+  Heatmap heatmap_;
+  uint32_t heatmap_decay_interval_ = 0;
+  float heatmap_decay_factor_ = 1.0f;
+#endif
+
+#ifdef USE_LD6001A_WARM_START
+  WarmStart<ZoneEngine::CAPACITY> warm_start_;
+  ESPPreferenceObject warm_pref_;
+  bool warm_hold_ = false;  // Restored state published, no radar frame since
+#endif
 
   InternalGPIOPin *reset_pin_ = nullptr;
 
-  Zone zone_config_[MAX_ZONES];
+  ZoneEngine zones_;
+  ZoneEngine::mask_type zones_changed_ = 0;  // Zones whose count changed since the sensors were last published
+  ZoneOccupancy<Person> zone_occupancy_{*this};
 #ifdef USE_NUMBER
   ESPPreferenceObject pref_;  // only used when numbers are in use
-  ZoneOfNumbers zone_numbers_[MAX_ZONES];
+  ZoneOfNumbers zone_numbers_[MAX_NUMBER_ZONES];
 #endif
 
 #ifdef USE_SENSOR
-  std::vector<sensor::Sensor *> move_x_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> move_y_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> move_z_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> move_distance_sensors_ = std::vector<sensor::Sensor *>(MAX_TARGETS);
-  std::vector<sensor::Sensor *> zone_target_count_sensors_ = std::vector<sensor::Sensor *>(MAX_ZONES);
+  std::array<FilteredSensor, MAX_TARGETS> move_x_sensors_{};
+  std::array<FilteredSensor, MAX_TARGETS> move_y_sensors_{};
+  std::array<FilteredSensor, MAX_TARGETS> move_z_sensors_{};
+  std::array<FilteredSensor, MAX_TARGETS> move_distance_sensors_{};
+  std::vector<sensor::Sensor *> zone_target_count_sensors_;  // Sized by the highest zone with a sensor
+  std::vector<sensor::Sensor *> zone_dwell_time_sensors_;
 #endif
 };
 
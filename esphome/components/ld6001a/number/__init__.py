@@ -17,7 +17,7 @@ from esphome.const import (
     UNIT_MILLISECOND,
 )
 
-from .. import CONF_LD6001A_ID, LD6001AComponent, ld6001a_ns, MAX_ZONES
+from .. import CONF_LD6001A_ID, LD6001AComponent, ld6001a_ns, MAX_NUMBER_ZONES
 
 GroundRadiusNumber = ld6001a_ns.class_("GroundRadiusNumber", number.Number)
 CoordinateType = ld6001a_ns.enum("CoordinateType")
@@ -145,7 +145,7 @@ CONFIG_SCHEMA = CONFIG_SCHEMA.extend(
                 ),
             }
         )
-        for n in range(MAX_ZONES)
+        for n in range(MAX_NUMBER_ZONES)
     }
 )
 
@@ -227,7 +227,7 @@ async def to_code(config):
 
             cg.add(getattr(ld6001a_component, setter)(n))
 
-    for zone_num in range(MAX_ZONES):
+    for zone_num in range(MAX_NUMBER_ZONES):
         if zone_conf := config.get(f"zone_{zone_num + 1}"):
             zone_x1_config = zone_conf.get(CONF_X1)
             
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace ld6001a {
+
+// Decides whether a new sensor value is worth publishing, to keep radar jitter out of the Home Assistant recorder.
+//
+// Changes of at least min_delta are published right away. Smaller changes are only published once max_interval has
+// passed since the last publish, so the state still converges on the real value. A value that did not change at all
+// is never published again, and going from or to NaN (target appeared or left) always is.
+class PublishFilter {
+ public:
+  void configure(float min_delta, uint32_t max_interval) {
+    this->min_delta_ = min_delta;
+    this->max_interval_ = max_interval;
+  }
+
+  // Returns whether value should be published at time now, and if so remembers it as the last published value
+  bool update(float value, uint32_t now) {
+    if (!this->should_publish_(value, now)) {
+      return false;
+    }
+
+    this->last_value_ = value;
+    this->last_publish_ = now;
+    return true;
+  }
+
+ protected:
+  bool should_publish_(float value, uint32_t now) const {
+    if (std::isnan(value) != std::isnan(this->last_value_)) {
+      return true;
+    }
+    if (std::isnan(value) || value == this->last_value_) {
+      return false;
+    }
+    if (std::fabs(value - this->last_value_) >= this->min_delta_) {
+      return true;
+    }
+
+    return this->max_interval_ > 0 && now - this->last_publish_ >= this->max_interval_;
+  }
+
+  float min_delta_ = 0;
+  uint32_t max_interval_ = 0;  // 0 disables publishing changes smaller than min_delta
+  float last_value_ = NAN;     // Like a sensor without state, so the first real value is always published
+  uint32_t last_publish_ = 0;
+};
+
+}  // namespace ld6001a
+}  // namespace esphome
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace esphome::ld6001a {
+
+struct ReadParamsResponse {
+  std::array<char, 16> software_version{};
+  float range_res;
+  float vel_res;
+  int time;
+  int prog;
+  int range;
+  int range_sensitivity;
+  int heart_beat_interval;
+  int protocol_mode;
+  int detection_height;
+  int x_nega;
+  int x_posi;
+  int y_nega;
+  int y_posi;
+  float moving_target_disappearance_time;
+  float static_target_disappearance_time;
+  float target_exit_time;
+};
+
+// Incremental parser for the parameter dump the module sends in reply to AT+READ. It looks like JSON, but it is not:
+//
+//   {\t\n"PeopleCntSoftVerison":NOP_1.07-01,\t\n"RangeRes":0.084,\t\n ... "detectionHeight":280,\t\n
+//   Moving target：5.0s,\t\nStatic target：60.0s,\t\nTarget exit：1.0s\t\n}
+//
+// Values are unquoted, the last three keys are unquoted and separated by a GBK full-width colon (0xA3 0xBA), and
+// times carry an "s" unit. Firmware older than NOP_1.07 names some keys differently ("SoftwareVersion", "Time",
+// "Prog") and stops after "Target exit：1.0s," without a closing brace.
+//
+// Every byte is looked at exactly once and the values go straight into the response, without building a string.
+class ReadParamsTokenizer {
+ public:
+  enum class Result {
+    MORE,         // Byte consumed, the response is not complete yet
+    DONE,         // Byte consumed and it completed the response
+    DONE_BEFORE,  // The response was already complete, this byte belongs to whatever comes next
+    INVALID,      // The byte cannot be part of a READ response
+  };
+
+  void reset() { *this = ReadParamsTokenizer{}; }
+
+  Result feed(uint8_t byte) {
+    if (this->state_ == State::AFTER_LAST) {
+      if (is_space(byte)) {
+        return Result::MORE;
+      }
+      this->state_ = State::FINISHED;
+      return byte == '}' ? Result::DONE : Result::DONE_BEFORE;
+    }
+
+    // The dump is plain text apart from the full-width colon, anything else means this was not a READ response
+    if (!is_text(byte)) {
+      return Result::INVALID;
+    }
+
+    switch (this->state_) {
+      case State::OPEN:
+        if (byte != '{') {
+          return Result::INVALID;
+        }
+        this->state_ = State::KEY_START;
+        break;
+
+      case State::KEY_START:
+        if (byte == '}') {
+          this->state_ = State::FINISHED;
+          return Result::DONE;
+        } else if (byte == '"') {
+          this->state_ = State::QUOTED_KEY;
+        } else if (!is_space(byte) && byte != ',') {
+          this->state_ = State::UNQUOTED_KEY;
+          this->key_.append(byte);
+        }
+        break;
+
+      case State::QUOTED_KEY:
+        if (byte == '"') {
+          this->state_ = State::SEPARATOR;
+        } else {
+          this->key_.append(byte);
+        }
+        break;
+
+      case State::UNQUOTED_KEY:
+        if (byte == ':') {
+          this->state_ = State::VALUE_START;
+        } else if (byte == FULLWIDTH_COLON[0]) {
+          this->state_ = State::FULLWIDTH_SEPARATOR;
+        } else {
+          this->key_.append(byte);
+        }
+        break;
+
+      case State::SEPARATOR:
+        if (byte == ':') {
+          this->state_ = State::VALUE_START;
+        } else if (byte == FULLWIDTH_COLON[0]) {
+          this->state_ = State::FULLWIDTH_SEPARATOR;
+        } else if (!is_space(byte)) {
+          return Result::INVALID;
+        }
+        break;
+
+      case State::FULLWIDTH_SEPARATOR:
+        if (byte != FULLWIDTH_COLON[1]) {
+          return Result::INVALID;
+        }
+        this->state_ = State::VALUE_START;
+        break;
+
+      case State::VALUE_START:
+        if (byte == '"') {
+          this->state_ = State::QUOTED_VALUE;
+        } else if (!is_space(byte)) {
+          this->state_ = State::VALUE;
+          this->value_.append(byte);
+        }
+        break;
+
+      case State::QUOTED_VALUE:
+        if (byte == '"') {
+          this->state_ = State::VALUE;
+        } else {
+          this->value_.append(byte);
+        }
+        break;
+
+      case State::VALUE:
+        if (byte == ',' || byte == '}' || is_space(byte)) {
+          return this->end_value_(byte);
+        }
+        this->value_.append(byte);
+        break;
+
+      default:
+        return Result::INVALID;
+    }
+
+    return Result::MORE;
+  }
+
+  // Old firmware ends with "Target exit：1.0s," and nothing else, so its response also counts as complete when the
+  // input runs out right after the last value. Newer firmware always closes with "}", which may still be on its way.
+  bool is_complete() const {
+    return this->old_format_ && this->state_ == State::AFTER_LAST && this->last_separator_ == ',';
+  }
+
+  const ReadParamsResponse &get_response() const { return this->response_; }
+
+ protected:
+  enum class State : uint8_t {
+    OPEN,
+    KEY_START,
+    QUOTED_KEY,
+    UNQUOTED_KEY,
+    SEPARATOR,
+    FULLWIDTH_SEPARATOR,
+    VALUE_START,
+    QUOTED_VALUE,
+    VALUE,
+    AFTER_LAST,
+    FINISHED,
+  };
+
+  // Fixed size token, longer keys and values are truncated. None of the known ones comes close.
+  struct Token {
+    std::array<char, 24> data{};
+    uint8_t len = 0;
+
+    void append(uint8_t byte) {
+      if (this->len + 1u < this->data.size()) {
+        this->data[this->len++] = byte;
+      }
+    }
+
+    const char *c_str() {
+      while (this->len > 0 && is_space(this->data[this->len - 1])) {
+        this->len--;
+      }
+      this->data[this->len] = '\0';
+      return this->data.data();
+    }
+
+    void clear() { this->len = 0; }
+  };
+
+  static constexpr uint8_t FULLWIDTH_COLON[2] = {0xA3, 0xBA};
+
+  static bool is_space(uint8_t byte) { return byte == ' ' || byte == '\t' || byte == '\r' || byte == '\n'; }
+
+  static bool is_text(uint8_t byte) {
+    return (byte >= 0x20 && byte < 0x7F) || is_space(byte) || byte == FULLWIDTH_COLON[0] ||
+           byte == FULLWIDTH_COLON[1];
+  }
+
+  Result end_value_(uint8_t separator) {
+    const char *key = this->key_.c_str();
+    const char *value = this->value_.c_str();
+    bool last = this->assign_(key, value);
+
+    this->key_.clear();
+    this->value_.clear();
+
+    if (separator == '}') {
+      this->state_ = State::FINISHED;
+      return Result::DONE;
+    }
+
+    this->state_ = last ? State::AFTER_LAST : State::KEY_START;
+    this->last_separator_ = separator;
+    return Result::MORE;
+  }
+
+  // Stores a value by its key and returns whether it was the last one of the dump. Numbers are read up to the first
+  // character that does not belong to them, which drops the "s" unit of the times.
+  bool assign_(const char *key, const char *value) {
+    auto &r = this->response_;
+    auto is = [key](const char *name) { return std::strcmp(key, name) == 0; };
+
+    if (is("PeopleCntSoftVerison") || is("SoftwareVersion")) {
+      this->old_format_ = is("SoftwareVersion");
+      std::strncpy(r.software_version.data(), value, r.software_version.size() - 1);
+    } else if (is("RangeRes")) {
+      r.range_res = std::strtof(value, nullptr);
+    } else if (is("VelRes")) {
+      r.vel_res = std::strtof(value, nullptr);
+    } else if (is("TIME") || is("Time")) {
+      r.time = std::strtol(value, nullptr, 10);
+    } else if (is("PROG") || is("Prog")) {
+      r.prog = std::strtol(value, nullptr, 10);
+    } else if (is("Range")) {
+      r.range = std::strtol(value, nullptr, 10);
+    } else if (is("Sen")) {
+      r.range_sensitivity = std::strtol(value, nullptr, 10);
+    } else if (is("Heart_Time")) {
+      r.heart_beat_interval = std::strtol(value, nullptr, 10);
+    } else if (is("Debug")) {
+      r.protocol_mode = std::strtol(value, nullptr, 10);
+    } else if (is("detectionHeight")) {
+      r.detection_height = std::strtol(value, nullptr, 10);
+    } else if (is("XboundaryN")) {
+      r.x_nega = std::strtol(value, nullptr, 10);
+    } else if (is("XboundaryP")) {
+      r.x_posi = std::strtol(value, nullptr, 10);
+    } else if (is("YboundaryN")) {
+      r.y_nega = std::strtol(value, nullptr, 10);
+    } else if (is("YboundaryP")) {
+      r.y_posi = std::strtol(value, nullptr, 10);
+    } else if (is("Moving target")) {
+      r.moving_target_disappearance_time = std::strtof(value, nullptr);
+    } else if (is("Static target")) {
+      r.static_target_disappearance_time = std::strtof(value, nullptr);
+    } else if (is("Target exit")) {
+      r.target_exit_time = std::strtof(value, nullptr);
+      return true;
+    }
+
+    return false;
+  }
+
+  State state_ = State::OPEN;
+  Token key_;
+  Token value_;
+  uint8_t last_separator_ = 0;
+  bool old_format_ = false;  // Firmware before NOP_1.07, whose dump has no closing brace
+  ReadParamsResponse response_{};
+};
+
+}  // namespace esphome::ld6001a
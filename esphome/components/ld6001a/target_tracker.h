@@ -1,9 +1,10 @@
 #pragma once
 
-#include <queue>
+#include <array>
 #include <cinttypes>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstddef>
+#include <utility>
+#include "esphome/core/hal.h"
 
 namespace esphome {
 namespace ld6001a {
@@ -15,48 +16,204 @@ class TargetEventHandler {
   virtual void on_target_left(T target_id, uint32_t dwell_time) = 0;
 };
 
-template<typename T>
+// Keeps track of the targets in view to report targets entering and leaving.
+//
+// Targets are kept in a fixed table of N slots and found through a small open addressing index on their id. A
+// bitmask marks the slots seen in the current frame, so an update is O(N) and never allocates.
+//
+// Optionally the tracker also smooths the positions of the targets, see smooth().
+template<typename T, size_t N = 16>
 class TargetTracker {
   using id_type = decltype(std::declval<T>().id);
+  using mask_type = uint32_t;
+
+  static_assert(N <= sizeof(mask_type) * 8, "Slot mask is too small for this many targets");
+
+  // Constant velocity estimate of one axis. The module measures the velocity itself, so unlike a textbook alpha-beta
+  // filter the velocity is corrected towards the measured one instead of being derived from the position residual.
+  struct AxisEstimate {
+    float position;
+    float velocity;
+
+    void reset(float measured_position, float measured_velocity) {
+      this->position = measured_position;
+      this->velocity = measured_velocity;
+    }
+
+    float update(float measured_position, float measured_velocity, float dt, float alpha, float beta) {
+      float predicted = this->position + this->velocity * dt;
+      this->position = predicted + alpha * (measured_position - predicted);
+      this->velocity += beta * (measured_velocity - this->velocity);
+      return this->position;
+    }
+  };
+
+  struct Slot {
+    T target;
+    uint32_t entry_time;
+    uint32_t last_seen_time;
+    bool estimated;  // The estimate below has been initialised by smooth()
+    uint32_t estimate_time;
+    std::array<AxisEstimate, 3> estimate;
+  };
 
  public:
-  TargetTracker(TargetEventHandler<id_type> &event_handler) : event_handler_(event_handler) {}
+  TargetTracker(TargetEventHandler<id_type> &event_handler) : event_handler_(event_handler) {
+    this->index_.fill(EMPTY);
+  }
+
+  template<typename Container> void update(const Container &targets) { this->update(targets, millis()); }
 
-  template<typename Container> void update(const Container &targets) {
-    auto now = millis();
-    auto unseen = std::unordered_set<id_type>();
+  template<typename Container> void update(const Container &targets, uint32_t now) {
+    mask_type seen = 0;
 
-    for (const auto &[key, _] : targets_) {
-      unseen.insert(key);
+    // Refresh the targets we already know about
+    for (const auto &target : targets) {
+      int slot = this->find_(target.id);
+
+      if (slot != EMPTY) {
+        this->slots_[slot].target = target;
+        this->slots_[slot].last_seen_time = now;
+        seen |= mask_type(1) << slot;
+      }
+    }
+
+    // Release the ones that are gone first, so their slots can be reused by new targets in the same frame
+    mask_type gone = this->used_ & ~seen;
+    for (size_t slot = 0, left = gone; left != 0; slot++, left >>= 1) {
+      if (left & 1) {
+        const auto &target = this->slots_[slot].target;
+        uint32_t dwell_time = (now - this->slots_[slot].entry_time) / 1000;
+
+        this->used_ &= ~(mask_type(1) << slot);
+        event_handler_.on_target_left(target.id, dwell_time);
+      }
+    }
+
+    if (gone != 0) {
+      this->rebuild_index_();
     }
 
     for (const auto &target : targets) {
-      unseen.erase(target.id);
-      targets_[target.id] = target;
+      if (this->find_(target.id) != EMPTY) {
+        continue;
+      }
 
-      if (entry_times_.find(target.id) == entry_times_.end()) {
-        entry_times_[target.id] = now;
-        event_handler_.on_target_enter(target.id);
+      int slot = this->allocate_(target.id);
+      if (slot == EMPTY) {
+        continue;  // More targets than slots, ignore the rest
       }
 
-      last_seen_times_[target.id] = now;
+      this->slots_[slot] = Slot{target, now, now, false, 0, {}};
+      event_handler_.on_target_enter(target.id);
     }
+  }
+
+  // Weights of the measured position (alpha) and velocity (beta) against the prediction, between 0 and 1. Lower
+  // values smooth more but lag behind. 1 for both passes the measurements through unchanged.
+  void set_smoothing(float alpha, float beta) {
+    this->alpha_ = alpha;
+    this->beta_ = beta;
+  }
+
+  bool is_smoothing() const { return this->alpha_ < 1 || this->beta_ < 1; }
 
-    for (const auto &target_id : unseen) {
-      if (entry_times_.find(target_id) != entry_times_.end()) {
-        uint32_t dwell_time = (now - entry_times_[target_id]) / 1000;
-        event_handler_.on_target_left(target_id, dwell_time);
-        entry_times_.erase(target_id);
-        last_seen_times_.erase(target_id);
+  // Replaces the position and velocity of the targets by the filtered estimate of their slot. Call it right after
+  // update() with the same targets, the first frame of a target only initialises its estimate. Targets that did not
+  // fit into a slot are left as they are.
+  template<typename Iterator> void smooth(Iterator begin, Iterator end, uint32_t now) {
+    if (!this->is_smoothing()) {
+      return;
+    }
+
+    for (auto it = begin; it != end; ++it) {
+      auto &target = *it;
+      int slot = this->find_(target.id);
+      if (slot == EMPTY) {
+        continue;
+      }
+
+      auto &state = this->slots_[slot];
+      auto &estimate = state.estimate;
+      if (!state.estimated) {
+        estimate[0].reset(target.x, target.vx);
+        estimate[1].reset(target.y, target.vy);
+        estimate[2].reset(target.z, target.vz);
+      } else {
+        float dt = (now - state.estimate_time) / 1000.0f;
+        target.x = estimate[0].update(target.x, target.vx, dt, this->alpha_, this->beta_);
+        target.y = estimate[1].update(target.y, target.vy, dt, this->alpha_, this->beta_);
+        target.z = estimate[2].update(target.z, target.vz, dt, this->alpha_, this->beta_);
+        target.vx = estimate[0].velocity;
+        target.vy = estimate[1].velocity;
+        target.vz = estimate[2].velocity;
       }
+
+      state.estimated = true;
+      state.estimate_time = now;
     }
   }
 
+  size_t size() const { return __builtin_popcount(this->used_); }
+  bool contains(id_type id) const { return this->find_(id) != EMPTY; }
+
  protected:
-  std::unordered_map<id_type, T> targets_;
+  static constexpr int8_t EMPTY = -1;
+  static constexpr size_t INDEX_SIZE = 2 * N;
+
+  size_t hash_(id_type id) const { return (static_cast<uint32_t>(id) * 2654435761u) % INDEX_SIZE; }
+
+  int find_(id_type id) const {
+    for (size_t i = 0, pos = this->hash_(id); i < INDEX_SIZE; i++, pos = (pos + 1) % INDEX_SIZE) {
+      int8_t slot = this->index_[pos];
+      if (slot == EMPTY) {
+        return EMPTY;
+      }
+      if (this->slots_[slot].target.id == id) {
+        return slot;
+      }
+    }
+    return EMPTY;
+  }
+
+  int allocate_(id_type id) {
+    if (this->used_ == ALL_USED) {
+      return EMPTY;
+    }
+
+    int slot = __builtin_ctz(~this->used_);
+    this->used_ |= mask_type(1) << slot;
+    this->slots_[slot].target.id = id;
+    this->insert_index_(id, slot);
+    return slot;
+  }
+
+  void insert_index_(id_type id, int8_t slot) {
+    size_t pos = this->hash_(id);
+    while (this->index_[pos] != EMPTY) {
+      pos = (pos + 1) % INDEX_SIZE;
+    }
+    this->index_[pos] = slot;
+  }
+
+  // Open addressing does not allow plain removal, with at most N entries rebuilding is cheap enough
+  void rebuild_index_() {
+    this->index_.fill(EMPTY);
+    for (size_t slot = 0; slot < N; slot++) {
+      if (this->used_ & (mask_type(1) << slot)) {
+        this->insert_index_(this->slots_[slot].target.id, slot);
+      }
+    }
+  }
+
+  static constexpr mask_type ALL_USED = N == sizeof(mask_type) * 8 ? ~mask_type(0) : (mask_type(1) << N) - 1;
+
   TargetEventHandler<id_type> &event_handler_;
-  std::unordered_map<id_type, uint32_t> entry_times_;
-  std::unordered_map<id_type, uint32_t> last_seen_times_;
+  std::array<Slot, N> slots_{};
+  std::array<int8_t, INDEX_SIZE> index_{};
+  mask_type used_ = 0;
+  float alpha_ = 1;
+  float beta_ = 1;
 };
 }  // namespace ld6001a
-}  // namespace esphome
\ No newline at end of file
+}  // namespace esphome
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace esphome {
+namespace ld6001a {
+
+static const uint8_t MAX_ZONE_VERTICES = 16;
+
+struct ZoneCoordinates {
+  int16_t x1 = 0;
+  int16_t y1 = 0;
+  int16_t x2 = 0;
+  int16_t y2 = 0;
+};
+
+// One polygon edge, prepared for the crossing test: a point at height y in [y_lo, y_hi) lies left of the edge if
+// x < x0 + slope * y. Horizontal edges are kept with an empty range, so they never count.
+struct ZoneEdge {
+  float y_lo;
+  float y_hi;
+  float x0;
+  float slope;
+
+  static ZoneEdge create(int16_t ax, int16_t ay, int16_t bx, int16_t by) {
+    if (ay == by) {
+      return ZoneEdge{float(ay), float(ay), 0, 0};
+    }
+    float slope = float(bx - ax) / float(by - ay);
+    return ZoneEdge{float(std::min(ay, by)), float(std::max(ay, by)), ax - slope * ay, slope};
+  }
+};
+
+}  // namespace ld6001a
+}  // namespace esphome
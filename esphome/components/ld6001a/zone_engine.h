@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+#include "zone.h"
+
+namespace esphome {
+namespace ld6001a {
+
+struct ZoneVertex {
+  int16_t x;
+  int16_t y;
+};
+
+// Counts the targets in many zones at once.
+//
+// The zones are kept as structure of arrays: bounding boxes, and the edges of all polygon zones packed into one table
+// with an offset per zone. A coarse uniform grid over all bounding boxes holds a bitmask of the zones touching each
+// cell, so a target is only tested against the few zones near it instead of all of them.
+//
+// Storage is sized while configuring, update() does not allocate.
+class ZoneEngine {
+ public:
+  using mask_type = uint64_t;
+
+  static constexpr size_t CAPACITY = sizeof(mask_type) * 8;
+  static constexpr int32_t GRID_SIZE = 8;  // Cells per axis
+
+  // Grows the number of zones, new zones start as the empty rectangle (0, 0) - (0, 0)
+  void ensure_size(size_t count) {
+    count = std::min(count, CAPACITY);
+    if (count <= this->size()) {
+      return;
+    }
+
+    this->x1_.resize(count, 0);
+    this->y1_.resize(count, 0);
+    this->x2_.resize(count, 0);
+    this->y2_.resize(count, 0);
+    this->edge_begin_.resize(count + 1, this->edges_.size());
+    this->counts_.resize(count, UNKNOWN_COUNT);
+    this->rebuild_grid_();
+  }
+
+  size_t size() const { return this->counts_.size(); }
+
+  void set_rectangle(size_t zone, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    if (zone >= CAPACITY) {
+      return;
+    }
+    this->ensure_size(zone + 1);
+    this->x1_[zone] = x1;
+    this->y1_[zone] = y1;
+    this->x2_[zone] = x2;
+    this->y2_[zone] = y2;
+    this->rebuild_grid_();
+  }
+
+  // Turns the zone into a polygon of at least three vertices, closed from the last vertex back to the first
+  bool set_polygon(size_t zone, std::initializer_list<ZoneVertex> vertices) {
+    if (vertices.size() < 3 || vertices.size() > MAX_ZONE_VERTICES || zone >= CAPACITY) {
+      return false;
+    }
+    this->ensure_size(zone + 1);
+
+    std::array<ZoneEdge, MAX_ZONE_VERTICES> edges;
+    auto begin = vertices.begin();
+    int16_t x1 = begin->x, y1 = begin->y, x2 = begin->x, y2 = begin->y;
+    for (size_t i = 0; i < vertices.size(); i++) {
+      const auto &a = begin[i];
+      const auto &b = begin[(i + 1) % vertices.size()];
+      edges[i] = ZoneEdge::create(a.x, a.y, b.x, b.y);
+      x1 = std::min(x1, a.x);
+      y1 = std::min(y1, a.y);
+      x2 = std::max(x2, a.x);
+      y2 = std::max(y2, a.y);
+    }
+
+    // Swap the edges of the zone in the packed table and move the offsets of the zones behind it
+    size_t old_count = this->get_edge_count_(zone);
+    auto first = this->edges_.begin() + this->edge_begin_[zone];
+    first = this->edges_.erase(first, first + old_count);
+    this->edges_.insert(first, edges.begin(), edges.begin() + vertices.size());
+
+    for (size_t i = zone + 1; i < this->edge_begin_.size(); i++) {
+      this->edge_begin_[i] = this->edge_begin_[i] - old_count + vertices.size();
+    }
+
+    this->set_rectangle(zone, x1, y1, x2, y2);
+    return true;
+  }
+
+  bool is_polygon(size_t zone) const { return this->get_edge_count_(zone) > 0; }
+  size_t get_vertex_count(size_t zone) const { return this->get_edge_count_(zone); }
+
+  ZoneCoordinates get_bounds(size_t zone) const {
+    ZoneCoordinates bounds;
+    bounds.x1 = this->x1_[zone];
+    bounds.y1 = this->y1_[zone];
+    bounds.x2 = this->x2_[zone];
+    bounds.y2 = this->y2_[zone];
+    return bounds;
+  }
+
+  bool contains(size_t zone, int16_t x, int16_t y) const {
+    if (!(x >= this->x1_[zone] && x <= this->x2_[zone] && y >= this->y1_[zone] && y <= this->y2_[zone])) {
+      return false;
+    }
+
+    auto begin = this->edges_.data() + this->edge_begin_[zone];
+    auto end = this->edges_.data() + this->edge_begin_[zone + 1];
+    if (begin == end) {
+      return true;
+    }
+
+    // Even-odd rule: count the edges crossed by a ray from the point to the right
+    bool inside = false;
+    for (auto edge = begin; edge != end; ++edge) {
+      inside ^= (y >= edge->y_lo) & (y < edge->y_hi) & (x < edge->x0 + edge->slope * y);
+    }
+    return inside;
+  }
+
+  // Counts the targets in every zone, target coordinates are in meters. Returns a mask of the zones whose count
+  // changed, after configuring that is every zone. When target_zones is given it receives the mask of the zones each
+  // target is in, in the order of the targets.
+  template<typename Container> mask_type update(const Container &targets, mask_type *target_zones = nullptr) {
+    std::array<uint8_t, CAPACITY> counts{};
+
+    for (const auto &target : targets) {
+      int16_t x = target.x * 100;
+      int16_t y = target.y * 100;
+
+      mask_type inside = 0;
+      for (mask_type candidates = this->get_candidates_(x, y); candidates != 0; candidates &= candidates - 1) {
+        size_t zone = __builtin_ctzll(candidates);
+        bool contained = this->contains(zone, x, y);
+        counts[zone] += contained;
+        inside |= mask_type(contained) << zone;
+      }
+
+      if (target_zones != nullptr) {
+        *target_zones++ = inside;
+      }
+    }
+
+    mask_type changed = 0;
+    for (size_t zone = 0; zone < this->size(); zone++) {
+      if (counts[zone] != this->counts_[zone]) {
+        this->counts_[zone] = counts[zone];
+        changed |= mask_type(1) << zone;
+      }
+    }
+    return changed;
+  }
+
+  uint8_t get_count(size_t zone) const { return this->counts_[zone] == UNKNOWN_COUNT ? 0 : this->counts_[zone]; }
+
+ protected:
+  static constexpr uint8_t UNKNOWN_COUNT = UINT8_MAX;  // Not counted yet, so the first update reports every zone
+
+  size_t get_edge_count_(size_t zone) const { return this->edge_begin_[zone + 1] - this->edge_begin_[zone]; }
+
+  mask_type get_candidates_(int16_t x, int16_t y) const {
+    int32_t cx = int32_t(x) - this->grid_x_;
+    int32_t cy = int32_t(y) - this->grid_y_;
+    if (cx < 0 || cy < 0 || cx >= this->grid_width_ || cy >= this->grid_height_) {
+      return 0;
+    }
+    return this->cells_[(cy * GRID_SIZE / this->grid_height_) * GRID_SIZE + cx * GRID_SIZE / this->grid_width_];
+  }
+
+  // Spreads the grid over the bounding boxes of all zones and marks the cells each zone overlaps
+  void rebuild_grid_() {
+    this->cells_.fill(0);
+    if (this->size() == 0) {
+      return;
+    }
+
+    int32_t x1 = *std::min_element(this->x1_.begin(), this->x1_.end());
+    int32_t y1 = *std::min_element(this->y1_.begin(), this->y1_.end());
+    int32_t x2 = *std::max_element(this->x2_.begin(), this->x2_.end());
+    int32_t y2 = *std::max_element(this->y2_.begin(), this->y2_.end());
+    this->grid_x_ = x1;
+    this->grid_y_ = y1;
+    this->grid_width_ = std::max(x2 - x1 + 1, 1);
+    this->grid_height_ = std::max(y2 - y1 + 1, 1);
+
+    for (size_t zone = 0; zone < this->size(); zone++) {
+      if (this->x1_[zone] > this->x2_[zone] || this->y1_[zone] > this->y2_[zone]) {
+        continue;  // Inverted rectangle, contains nothing
+      }
+
+      int32_t col1 = (this->x1_[zone] - this->grid_x_) * GRID_SIZE / this->grid_width_;
+      int32_t col2 = (this->x2_[zone] - this->grid_x_) * GRID_SIZE / this->grid_width_;
+      int32_t row1 = (this->y1_[zone] - this->grid_y_) * GRID_SIZE / this->grid_height_;
+      int32_t row2 = (this->y2_[zone] - this->grid_y_) * GRID_SIZE / this->grid_height_;
+
+      for (int32_t row = row1; row <= row2; row++) {
+        for (int32_t col = col1; col <= col2; col++) {
+          this->cells_[row * GRID_SIZE + col] |= mask_type(1) << zone;
+        }
+      }
+    }
+  }
+
+  std::vector<int16_t> x1_;
+  std::vector<int16_t> y1_;
+  std::vector<int16_t> x2_;
+  std::vector<int16_t> y2_;
+  std::vector<uint16_t> edge_begin_{0};  // Edges of zone i are edges_[edge_begin_[i]] up to edges_[edge_begin_[i + 1]]
+  std::vector<ZoneEdge> edges_;
+  std::vector<uint8_t> counts_;
+
+  std::array<mask_type, GRID_SIZE * GRID_SIZE> cells_{};
+  int32_t grid_x_ = 0;
+  int32_t grid_y_ = 0;
+  int32_t grid_width_ = 1;
+  int32_t grid_height_ = 1;
+};
+
+}  // namespace ld6001a
+}  // namespace esphome
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace esphome {
+namespace ld6001a {
+
+template<typename T>
+class ZoneEventHandler {
+ public:
+  virtual void on_zone_enter(uint8_t zone, T target_id) = 0;
+  virtual void on_zone_left(uint8_t zone, T target_id, uint32_t dwell_time) = 0;
+};
+
+// Follows which target is in which zone to report targets entering and leaving zones, and how long zones have been
+// occupied.
+//
+// Fed with the zone mask of every target of a frame (see ZoneEngine::update()). Memberships of a target in a zone are
+// kept in a fixed table of N entries, since a target is rarely in more than one or two zones at once.
+template<typename T, size_t N = 32>
+class ZoneOccupancy {
+  using id_type = decltype(std::declval<T>().id);
+
+ public:
+  using mask_type = uint64_t;
+
+  static constexpr size_t MAX_ZONES = sizeof(mask_type) * 8;
+
+  ZoneOccupancy(ZoneEventHandler<id_type> &event_handler) : event_handler_(event_handler) {}
+
+  // zones[i] is the mask of the zones targets[i] is in
+  template<typename Container> void update(const Container &targets, const mask_type *zones, uint32_t now) {
+    // Leaves first, like the TargetTracker
+    for (size_t i = 0; i < this->size_;) {
+      auto &membership = this->memberships_[i];
+      if (this->find_zones_(targets, zones, membership.id) & (mask_type(1) << membership.zone)) {
+        i++;
+        continue;
+      }
+
+      auto left = membership;
+      membership = this->memberships_[--this->size_];
+      this->event_handler_.on_zone_left(left.zone, left.id, (now - left.entry_time) / 1000);
+    }
+
+    size_t index = 0;
+    mask_type occupied = 0;
+    for (const auto &target : targets) {
+      mask_type target_zones = zones[index++];
+      occupied |= target_zones;
+
+      for (mask_type entered = target_zones & ~this->find_memberships_(target.id); entered != 0;
+           entered &= entered - 1) {
+        if (this->size_ == N) {
+          break;  // More memberships than entries, ignore the rest
+        }
+
+        uint8_t zone = __builtin_ctzll(entered);
+        this->memberships_[this->size_++] = Membership{target.id, zone, now};
+        this->event_handler_.on_zone_enter(zone, target.id);
+      }
+    }
+
+    for (mask_type changed = occupied ^ this->occupied_; changed != 0; changed &= changed - 1) {
+      size_t zone = __builtin_ctzll(changed);
+      if (occupied & (mask_type(1) << zone)) {
+        this->occupied_since_[zone] = now;
+      } else {
+        this->total_time_[zone] += now - this->occupied_since_[zone];
+      }
+    }
+    this->occupied_ = occupied;
+  }
+
+  bool is_occupied(size_t zone) const { return this->occupied_ & (mask_type(1) << zone); }
+
+  // Milliseconds the zone has been occupied without interruption, 0 if it is empty
+  uint32_t get_dwell_time(size_t zone, uint32_t now) const {
+    return this->is_occupied(zone) ? now - this->occupied_since_[zone] : 0;
+  }
+
+  // Milliseconds the zone has been occupied in total since boot
+  uint32_t get_total_time(size_t zone, uint32_t now) const {
+    return this->total_time_[zone] + this->get_dwell_time(zone, now);
+  }
+
+  size_t size() const { return this->size_; }
+
+ protected:
+  struct Membership {
+    id_type id;
+    uint8_t zone;
+    uint32_t entry_time;
+  };
+
+  template<typename Container>
+  static mask_type find_zones_(const Container &targets, const mask_type *zones, id_type id) {
+    size_t index = 0;
+    for (const auto &target : targets) {
+      if (target.id == id) {
+        return zones[index];
+      }
+      index++;
+    }
+    return 0;
+  }
+
+  mask_type find_memberships_(id_type id) const {
+    mask_type mask = 0;
+    for (size_t i = 0; i < this->size_; i++) {
+      if (this->memberships_[i].id == id) {
+        mask |= mask_type(1) << this->memberships_[i].zone;
+      }
+    }
+    return mask;
+  }
+
+  ZoneEventHandler<id_type> &event_handler_;
+  std::array<Membership, N> memberships_{};
+  size_t size_ = 0;
+
+  mask_type occupied_ = 0;
+  std::array<uint32_t, MAX_ZONES> occupied_since_{};
+  std::array<uint32_t, MAX_ZONES> total_time_{};
+};
+
+}  // namespace ld6001a
+}  // namespace esphome
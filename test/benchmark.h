@@ -0,0 +1,103 @@
+#pragma once
+
+// Shared helpers for the native benchmarks in test/*/test_benchmark*, run them with `pio test -e benchmark -v`.
+//
+// Every result is printed as a single line JSON object, e.g.
+//
+//   {"benchmark":"ld6001a_parser","case":"noisy","unit":"ns/byte","value":3.52}
+//
+// so results can be grepped from the test output and appended to a per-commit history.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include "unity.h"
+
+namespace benchmark {
+
+// Calls fn() `iterations` times per sample and returns the fastest sample in ns per call. The minimum is the least
+// noisy estimate on a shared machine.
+template<typename F> double measure_ns(size_t iterations, F &&fn, size_t samples = 5) {
+  fn();  // Warm up caches and branch predictors
+
+  double best = std::numeric_limits<double>::max();
+  for (size_t sample = 0; sample < samples; sample++) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+      fn();
+    }
+    best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  return best / iterations;
+}
+
+inline void report(const char *benchmark, const char *variant, const char *unit, double value) {
+  TEST_PRINTF("{\"benchmark\":\"%s\",\"case\":\"%s\",\"unit\":\"%s\",\"value\":%.3f}", benchmark, variant, unit, value);
+}
+
+// A UART byte stream and the sizes of the reads it arrives in
+struct Stream {
+  std::vector<uint8_t> bytes;
+  std::vector<size_t> chunks;
+  size_t frames = 0;
+};
+
+// Builds the clean, noisy and fragmented variants of a stream of frames. Noise bytes are taken from 0x80-0xFE, which
+// never starts a frame for either radar, so every frame must still be parsed.
+class StreamBuilder {
+ public:
+  explicit StreamBuilder(uint32_t seed = 42) : rng_(seed) {}
+
+  // Frames back to back, read in chunks of up to 128 bytes like the components do
+  Stream clean(const std::vector<std::vector<uint8_t>> &frames) { return this->build_(frames, 0, 128, 128); }
+
+  // Up to `max_noise` garbage bytes between frames
+  Stream noisy(const std::vector<std::vector<uint8_t>> &frames, size_t max_noise = 16) {
+    return this->build_(frames, max_noise, 128, 128);
+  }
+
+  // Frames arriving a few bytes at a time, e.g. when the loop runs faster than the UART
+  Stream fragmented(const std::vector<std::vector<uint8_t>> &frames) { return this->build_(frames, 0, 1, 8); }
+
+ protected:
+  Stream build_(const std::vector<std::vector<uint8_t>> &frames, size_t max_noise, size_t min_chunk,
+                size_t max_chunk) {
+    Stream stream;
+    std::uniform_int_distribution<size_t> noise_length(0, max_noise);
+    std::uniform_int_distribution<int> noise_byte(0x80, 0xFE);
+    std::uniform_int_distribution<size_t> chunk_length(min_chunk, max_chunk);
+
+    for (const auto &frame : frames) {
+      for (size_t i = noise_length(this->rng_); i > 0; i--) {
+        stream.bytes.push_back(noise_byte(this->rng_));
+      }
+      stream.bytes.insert(stream.bytes.end(), frame.begin(), frame.end());
+      stream.frames++;
+    }
+
+    for (size_t remaining = stream.bytes.size(); remaining > 0;) {
+      size_t chunk = std::min(remaining, chunk_length(this->rng_));
+      stream.chunks.push_back(chunk);
+      remaining -= chunk;
+    }
+
+    return stream;
+  }
+
+  std::mt19937 rng_;
+};
+
+// Feeds the stream to anything with push_data(const uint8_t *, size_t), the way read_uart_() does
+template<typename Parser> void feed(Parser &parser, const Stream &stream) {
+  const uint8_t *data = stream.bytes.data();
+  for (size_t chunk : stream.chunks) {
+    parser.push_data(data, chunk);
+    data += chunk;
+  }
+}
+
+}  // namespace benchmark
@@ -0,0 +1,108 @@
+#define UNITY_INCLUDE_PRINT_FORMATTED 1
+
+#include "unity.h"
+#include <vector>
+#include "ld6001/frame_parser.h"  // Include the header file for the class being tested
+#include "ld6001/zone.h"
+#include "../../benchmark.h"
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001;
+
+class CountingFrameHandler : public FrameHandler {
+  public:
+    size_t frames = 0;
+
+    void on_radar_response(const RadarResponse &response) override {
+      frames++;
+    }
+};
+
+// Builds a radar (0x62) frame for the given number of targets, including checksum and end byte
+std::vector<uint8_t> build_radar_frame(uint8_t targets) {
+  std::vector<uint8_t> frame = {0x4D, 0x62, static_cast<uint8_t>((targets + 1) * 8), 0x00, 0x00, targets,
+                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+  for (uint8_t i = 0; i < targets; i++) {
+    frame.insert(frame.end(), {i, 200, 120, 90, 0x00, 0x00, static_cast<uint8_t>(-100 + i * 20), 50});
+  }
+
+  frame.push_back(FrameParser::get_iterator_checksum(frame.begin(), frame.end()));
+  frame.push_back(0x4A);
+  return frame;
+}
+
+void measure_stream(const char *variant, const benchmark::Stream &stream) {
+  CountingFrameHandler handler;
+  FrameParser parser(handler);
+
+  double ns_per_stream = benchmark::measure_ns(20, [&]() { benchmark::feed(parser, stream); });
+  benchmark::report("ld6001_parser", variant, "ns/byte", ns_per_stream / stream.bytes.size());
+
+  // Warm up plus 5 samples of 20 runs, every frame must have been found every time
+  TEST_ASSERT_EQUAL(101 * stream.frames, handler.frames);
+}
+
+void test_parser_streams(void) {
+  std::vector<std::vector<uint8_t>> frames;
+  for (size_t i = 0; i < 200; i++) {
+    frames.push_back(build_radar_frame(i % (MAX_TARGETS + 1)));
+  }
+
+  benchmark::StreamBuilder builder;
+  measure_stream("clean", builder.clean(frames));
+  measure_stream("noisy", builder.noisy(frames));
+  measure_stream("fragmented", builder.fragmented(frames));
+}
+
+// The zone loop of update_sensors_(): every zone against every target of a full frame
+void test_zone_evaluation(void) {
+  class LastResponseHandler : public FrameHandler {
+    public:
+      RadarResponse response{};
+
+      void on_radar_response(const RadarResponse &response) override {
+        this->response = response;
+      }
+  };
+
+  LastResponseHandler last;
+  FrameParser response_parser(last);
+  auto frame = build_radar_frame(MAX_TARGETS);
+  response_parser.push_data(frame.data(), frame.size());
+  Span<Target> targets(last.response.people, last.response.targets);
+  TEST_ASSERT_EQUAL(MAX_TARGETS, targets.size());
+
+  static const size_t ZONES = 4;
+  Zone zones[ZONES];
+  for (size_t i = 0; i < ZONES; i++) {
+    zones[i].x1 = -1000 + i * 500;
+    zones[i].x2 = zones[i].x1 + 500;
+    zones[i].y1 = -1000;
+    zones[i].y2 = 1000;
+  }
+
+  volatile uint32_t sink = 0;
+  double ns_per_update = benchmark::measure_ns(100000, [&]() {
+    for (auto &zone : zones) {
+      zone.target_count = zone.count_targets(targets);
+      sink = sink + zone.target_count;
+    }
+  });
+
+  benchmark::report("ld6001_zones", "4_zones_10_targets", "ns/evaluation", ns_per_update / (ZONES * MAX_TARGETS));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_parser_streams);
+  RUN_TEST(test_zone_evaluation);
+  return UNITY_END();
+}
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { 
+  return runUnityTests(); 
+}
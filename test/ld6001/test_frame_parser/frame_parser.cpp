@@ -104,10 +104,114 @@ void test_it_should_parse_radar_response(void) {
   TEST_ASSERT_EQUAL(-1100, handler.response.people[0].y);
 }
 
+void test_it_should_resync_after_garbage(void) {
+  class InlineFrameHandler : public FrameHandler {
+    public:
+      int responses = 0;
+      StatusResponse response{};
+
+      void on_status_response(const StatusResponse &response) override {
+        this->responses++;
+        this->response = response;
+      }
+  };
+
+  InlineFrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  // Noise, including a frame start byte that does not lead to a valid frame
+  for (uint8_t c : std::vector<uint8_t>{0x00, 0xFF, 0x4D, 0x11, 0x02, 0x13, 0x37, 0x00, 0x00, 0x12, 0x4A}) {
+    frame_iterator.push_data(c);
+  }
+
+  write_with_checksum(
+    frame_iterator,
+    std::vector<uint8_t>{0x4D, 0x11, 0x08, 0x00, 0x01, 0x02, 0x03, 0x04, 0x00, 0x01, 0x00, 0x00}
+  );
+
+  TEST_ASSERT_EQUAL(1, handler.responses);
+  TEST_ASSERT_EQUAL(0x01, handler.response.software_version_minor);
+  TEST_ASSERT_EQUAL(0x04, handler.response.hardware_version_major);
+  TEST_ASSERT_EQUAL(0, frame_iterator.get_bytes_dropped());
+}
+
+void test_it_should_parse_multiple_frames_from_one_chunk(void) {
+  class InlineFrameHandler : public FrameHandler {
+    public:
+      int status_responses = 0;
+      int radar_responses = 0;
+
+      void on_status_response(const StatusResponse &response) override {
+        this->status_responses++;
+      }
+
+      void on_radar_response(const RadarResponse &response) override {
+        this->radar_responses++;
+      }
+  };
+
+  InlineFrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  const uint8_t chunk[] = {
+    0x4D, 0x11, 0x08, 0x00, 0x01, 0x02, 0x03, 0x04, 0x00, 0x01, 0x00, 0x00, 113, 0x4A,
+    0x00, 0x13, 0x37,
+    0x4D, 0x62, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xB7, 0x4A,
+    0x4D, 0x11, 0x08, 0x00, 0x01, 0x02, 0x03, 0x04, 0x00, 0x01, 0x00, 0x00, 113, 0x4A,
+  };
+  frame_iterator.push_data(chunk, sizeof(chunk));
+
+  TEST_ASSERT_EQUAL(2, handler.status_responses);
+  TEST_ASSERT_EQUAL(1, handler.radar_responses);
+}
+
+void test_it_should_count_link_errors(void) {
+  FrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  const uint8_t chunk[] = {
+    0x4D, 0x11, 0x08, 0x00, 0x01, 0x02, 0x03, 0x04, 0x00, 0x01, 0x00, 0x00, 112, 0x4A,  // Bad checksum
+    0x00, 0x13, 0x37,
+    0x4D, 0x62, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xB7, 0x4A,
+  };
+  frame_iterator.push_data(chunk, sizeof(chunk));
+
+  const ParserStats &stats = frame_iterator.get_stats();
+  TEST_ASSERT_EQUAL(1, stats.get_frames(FrameType::RADAR));
+  TEST_ASSERT_EQUAL(0, stats.get_frames(FrameType::STATUS));
+  TEST_ASSERT_EQUAL(1, stats.checksum_failures);
+  TEST_ASSERT_EQUAL(14 + 3, stats.bytes_discarded);
+  TEST_ASSERT_EQUAL(0, stats.buffer_overflows);
+}
+
+void test_frame_buffer_should_count_dropped_bytes(void) {
+  FrameBuffer<8> buffer;
+  std::array<uint8_t, 6> data = {1, 2, 3, 4, 5, 6};
+
+  TEST_ASSERT_EQUAL(6, buffer.push(data.data(), data.size()));
+  buffer.consume(4);
+  TEST_ASSERT_EQUAL(2, buffer.size());
+  TEST_ASSERT_EQUAL(5, buffer[0]);
+
+  // Compacts the remaining two bytes to make room, the last two do not fit
+  TEST_ASSERT_EQUAL(6, buffer.push(data.data(), data.size()));
+  TEST_ASSERT_EQUAL(8, buffer.size());
+  TEST_ASSERT_EQUAL(0, buffer.get_dropped());
+  TEST_ASSERT_EQUAL(false, buffer.push(0x07));
+  TEST_ASSERT_EQUAL(1, buffer.get_dropped());
+
+  buffer.consume(8);
+  TEST_ASSERT_EQUAL(true, buffer.empty());
+}
+
 int runUnityTests(void) {
   UNITY_BEGIN();
   RUN_TEST(test_it_should_parse_status_response);
   RUN_TEST(test_it_should_parse_radar_response);
+  RUN_TEST(test_it_should_resync_after_garbage);
+  RUN_TEST(test_it_should_parse_multiple_frames_from_one_chunk);
+  RUN_TEST(test_it_should_count_link_errors);
+  RUN_TEST(test_frame_buffer_should_count_dropped_bytes);
   return UNITY_END();
 }
 
@@ -0,0 +1,50 @@
+#include "unity.h"
+#include <vector>
+#include "ld6001/zone.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001;
+
+struct FakeTarget {
+  int16_t x;
+  int16_t y;
+};
+
+void test_it_should_count_targets_in_cm(void) {
+  Zone zone;
+  zone.x1 = -100;
+  zone.y1 = 0;
+  zone.x2 = 100;
+  zone.y2 = 200;
+  std::vector<FakeTarget> targets{{0, 100}, {-100, 200}, {150, 100}, {0, -10}};
+
+  TEST_ASSERT_EQUAL(2, zone.count_targets(targets));
+}
+
+void test_it_should_count_targets_in_polygon(void) {
+  // Triangle pointing away from the sensor
+  Zone zone;
+  zone.add_vertex(-100, 0);
+  zone.add_vertex(100, 0);
+  zone.add_vertex(0, 200);
+  std::vector<FakeTarget> targets{{0, 100}, {-90, 150}, {90, 150}, {0, 10}};
+
+  TEST_ASSERT_EQUAL(2, zone.count_targets(targets));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_count_targets_in_cm);
+  RUN_TEST(test_it_should_count_targets_in_polygon);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
@@ -0,0 +1,170 @@
+#define UNITY_INCLUDE_PRINT_FORMATTED 1
+
+#include "unity.h"
+#include <chrono>
+#include <vector>
+#include "ld6001a/frame_parser.h"
+#include "../../benchmark.h"
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+class CountingFrameHandler : public FrameHandler {
+  public:
+    size_t frames = 0;
+
+    void on_detailed_radar_response(Span<Person> people) override {
+      frames++;
+    }
+};
+
+// Builds a detailed (type 2) frame for the given number of people, including a valid checksum
+std::vector<uint8_t> build_detailed_frame(size_t people) {
+  std::vector<uint8_t> frame = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+  uint32_t track_length = people * 32;
+  uint32_t length = 32 + track_length;
+
+  auto push_uint32 = [&frame](uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+      frame.push_back((value >> (i * 8)) & 0xFF);
+    }
+  };
+
+  push_uint32(length);
+  push_uint32(0x01A3);
+  push_uint32(1);
+  push_uint32(0);
+  push_uint32(2);
+  push_uint32(track_length);
+
+  for (size_t i = 0; i < people; i++) {
+    push_uint32(0);
+    push_uint32(i);
+    for (float value : {-1.17f, 2.5f, 0.32f, 0.09f, -0.07f, 0.001f}) {
+      Uint32Bytes u32;
+      std::memcpy(&u32.u, &value, sizeof(float));
+      push_uint32(u32.u);
+    }
+  }
+
+  uint8_t checksum = 0;
+  for (size_t i = 12; i < 16; i++) {
+    checksum ^= frame[i];
+  }
+  for (size_t i = 32; i < frame.size(); i++) {
+    checksum ^= frame[i];
+  }
+  frame.push_back(checksum);
+
+  return frame;
+}
+
+// Pushes the frame byte by byte, which is the worst case for a parser that rescans its buffer on every byte
+double measure_ns_per_byte(size_t people, size_t iterations, size_t &frames) {
+  CountingFrameHandler handler;
+  FrameParser parser(handler);
+  auto frame = build_detailed_frame(people);
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    for (uint8_t byte : frame) {
+      parser.push_data(byte);
+    }
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  frames = handler.frames;
+  return elapsed / (iterations * frame.size());
+}
+
+// Time spent on the final (checksum) byte only, which is where a frame is validated and handed to the handler
+double measure_ns_to_complete(size_t people, size_t iterations, size_t &frames) {
+  CountingFrameHandler handler;
+  FrameParser parser(handler);
+  auto frame = build_detailed_frame(people);
+  double elapsed = 0;
+
+  for (size_t i = 0; i < iterations; i++) {
+    parser.push_data(frame.data(), frame.size() - 1);
+
+    auto start = std::chrono::steady_clock::now();
+    parser.push_data(frame.back());
+    elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  frames = handler.frames;
+
+  return elapsed / iterations;
+}
+
+void test_bytewise_cost_by_frame_size(void) {
+  size_t frames = 0;
+
+  // Warm up caches and the allocator
+  measure_ns_per_byte(1, 100, frames);
+
+  double small = measure_ns_per_byte(1, 2000, frames);
+  TEST_ASSERT_EQUAL(2000, frames);
+  double large = measure_ns_per_byte(10, 2000, frames);
+  TEST_ASSERT_EQUAL(2000, frames);
+
+  benchmark::report("ld6001a_parser", "bytewise_1_people", "ns/byte", small);
+  // Every byte is looked at once, so the per byte cost should not grow with the frame. Wall clock ratios depend on
+  // the machine and build flags, so they are reported to compare between commits rather than asserted.
+  benchmark::report("ld6001a_parser", "bytewise_10_people", "ns/byte", large);
+}
+
+void test_completion_cost_by_frame_size(void) {
+  size_t frames = 0;
+
+  measure_ns_to_complete(1, 100, frames);
+
+  double small = measure_ns_to_complete(1, 2000, frames);
+  TEST_ASSERT_EQUAL(2000, frames);
+  double large = measure_ns_to_complete(10, 2000, frames);
+  TEST_ASSERT_EQUAL(2000, frames);
+
+  benchmark::report("ld6001a_parser", "complete_1_people", "ns/frame", small);
+  // Only decoding the people should scale with the frame. Validating the checksum over the whole frame on the last
+  // byte made this roughly 2.7x from 1 to 10 people, with the running checksum it is about 1.5x with -O2.
+  benchmark::report("ld6001a_parser", "complete_10_people", "ns/frame", large);
+}
+
+void measure_stream(const char *variant, const benchmark::Stream &stream) {
+  CountingFrameHandler handler;
+  FrameParser parser(handler);
+
+  double ns_per_stream = benchmark::measure_ns(20, [&]() { benchmark::feed(parser, stream); });
+  benchmark::report("ld6001a_parser", variant, "ns/byte", ns_per_stream / stream.bytes.size());
+
+  // Warm up plus 5 samples of 20 runs, every frame must have been found every time
+  TEST_ASSERT_EQUAL(101 * stream.frames, handler.frames);
+}
+
+void test_parser_streams(void) {
+  std::vector<std::vector<uint8_t>> frames;
+  for (size_t i = 0; i < 200; i++) {
+    frames.push_back(build_detailed_frame(i % (MAX_TARGETS + 1)));
+  }
+
+  benchmark::StreamBuilder builder;
+  measure_stream("clean", builder.clean(frames));
+  measure_stream("noisy", builder.noisy(frames));
+  measure_stream("fragmented", builder.fragmented(frames));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bytewise_cost_by_frame_size);
+  RUN_TEST(test_completion_cost_by_frame_size);
+  RUN_TEST(test_parser_streams);
+  return UNITY_END();
+}
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { 
+  return runUnityTests(); 
+}
@@ -0,0 +1,157 @@
+#define UNITY_INCLUDE_PRINT_FORMATTED 1
+
+#include "unity.h"
+#include <array>
+#include <vector>
+#include "ld6001a/target_tracker.h"  // Include the header file for the class being tested
+#include "ld6001a/frame_parser.h"
+#include "ld6001a/zone_engine.h"
+#include "../../benchmark.h"
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+class CountingEventHandler : public TargetEventHandler<uint32_t> {
+  public:
+    uint32_t entered = 0;
+    uint32_t left = 0;
+
+    void on_target_enter(uint32_t target_id) override { entered++; }
+    void on_target_left(uint32_t target_id, uint32_t dwell_time) override { left++; }
+};
+
+// Frames of MAX_TARGETS people walking around. Every `churn` frames one of them is replaced by a new id, so the
+// enter/leave paths are part of the measurement.
+std::vector<std::array<Person, MAX_TARGETS>> build_frames(size_t count, size_t churn) {
+  std::vector<std::array<Person, MAX_TARGETS>> frames(count);
+  uint32_t next_id = MAX_TARGETS;
+  std::array<uint32_t, MAX_TARGETS> ids;
+  for (uint32_t i = 0; i < MAX_TARGETS; i++) {
+    ids[i] = i;
+  }
+
+  for (size_t f = 0; f < count; f++) {
+    if (churn > 0 && f % churn == 0) {
+      ids[f % MAX_TARGETS] = next_id++;
+    }
+    for (size_t i = 0; i < MAX_TARGETS; i++) {
+      float t = f * 0.01f + i;
+      frames[f][i] = Person{ids[i], -2.0f + (t - int(t)) * 4.0f, -1.5f + i * 0.3f, 1.0f, 0.4f, 0.0f, 0.0f};
+    }
+  }
+
+  return frames;
+}
+
+void measure_tracker(const char *variant, size_t churn) {
+  auto frames = build_frames(1000, churn);
+  CountingEventHandler handler;
+  TargetTracker<Person> tracker(handler);
+  uint32_t now = 0;
+
+  double ns_per_run = benchmark::measure_ns(20, [&]() {
+    for (const auto &frame : frames) {
+      tracker.update(Span<Person>(frame.data(), frame.size()), now += 100);
+    }
+  });
+
+  benchmark::report("ld6001a_tracker", variant, "ns/frame", ns_per_run / frames.size());
+  TEST_ASSERT_EQUAL(MAX_TARGETS, tracker.size());
+}
+
+void test_tracker_update(void) {
+  measure_tracker("10_targets_stable", 0);
+  measure_tracker("10_targets_churn", 20);
+}
+
+static const size_t ZONES = 4;
+
+// The zone update of on_detailed_radar_response(): every zone against every target of a full frame
+void measure_zones(const char *name, ZoneEngine &engine) {
+  auto frame = build_frames(1, 0)[0];
+  Span<Person> targets(frame.data(), frame.size());
+
+  volatile uint32_t sink = 0;
+  double ns_per_update = benchmark::measure_ns(100000, [&]() {
+    engine.update(targets);
+    sink = sink + engine.get_count(0);
+  });
+
+  benchmark::report("ld6001a_zones", name, "ns/evaluation", ns_per_update / (ZONES * MAX_TARGETS));
+}
+
+void test_zone_evaluation(void) {
+  ZoneEngine engine;
+  for (size_t i = 0; i < ZONES; i++) {
+    int16_t x = -200 + i * 100;
+    engine.set_rectangle(i, x, -150, x + 100, 150);
+  }
+
+  measure_zones("4_zones_10_targets", engine);
+}
+
+// Same areas as L-shaped hexagons, so most targets fall into the bounding box and need the crossing test
+void test_polygon_zone_evaluation(void) {
+  ZoneEngine engine;
+  for (size_t i = 0; i < ZONES; i++) {
+    int16_t x = -200 + i * 100;
+    engine.set_polygon(i, {{x, -150},
+                           {int16_t(x + 100), -150},
+                           {int16_t(x + 100), 0},
+                           {int16_t(x + 50), 0},
+                           {int16_t(x + 50), 150},
+                           {x, 150}});
+  }
+
+  measure_zones("4_polygon_zones_10_targets", engine);
+}
+
+// 64 desks in an 8x8 raster over the area the targets walk in, every target against every zone versus the grid index
+// of the zone engine. Both cover the full update of a frame.
+void test_many_zones_evaluation(void) {
+  static const size_t MANY_ZONES = ZoneEngine::CAPACITY;
+  auto frames = build_frames(100, 0);
+
+  ZoneEngine engine;
+  for (size_t i = 0; i < MANY_ZONES; i++) {
+    int16_t x = -240 + (i % 8) * 60;
+    int16_t y = -180 + (i / 8) * 45;
+    engine.set_rectangle(i, x, y, x + 50, y + 35);
+  }
+
+  volatile uint32_t sink = 0;
+  double ns_per_run = benchmark::measure_ns(100, [&]() {
+    for (const auto &frame : frames) {
+      for (size_t zone = 0; zone < MANY_ZONES; zone++) {
+        for (const auto &target : frame) {
+          sink = sink + engine.contains(zone, target.x * 100, target.y * 100);
+        }
+      }
+    }
+  });
+  benchmark::report("ld6001a_zones", "64_zones_10_targets", "ns/frame", ns_per_run / frames.size());
+
+  ns_per_run = benchmark::measure_ns(100, [&]() {
+    for (const auto &frame : frames) {
+      sink = sink + engine.update(Span<Person>(frame.data(), frame.size()));
+    }
+  });
+  benchmark::report("ld6001a_zones", "64_zones_10_targets_engine", "ns/frame", ns_per_run / frames.size());
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_tracker_update);
+  RUN_TEST(test_zone_evaluation);
+  RUN_TEST(test_polygon_zone_evaluation);
+  RUN_TEST(test_many_zones_evaluation);
+  return UNITY_END();
+}
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { 
+  return runUnityTests(); 
+}
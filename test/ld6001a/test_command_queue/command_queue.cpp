@@ -0,0 +1,384 @@
+#include "unity.h"
+#include <string>
+#include <vector>
+#include "ld6001a/command_queue.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+class FakeCommandHandler : public CommandHandler {
+ public:
+  std::vector<std::string> sent;
+  std::vector<Command> done;
+  std::vector<Command> failed;
+  CommandQueue *queue = nullptr;
+  bool read_after_restore = false;
+
+  void send_command(const Command &command) override { sent.push_back(command.c_str()); }
+
+  void on_command_failed(const Command &command) override { failed.push_back(command); }
+
+  void on_command_done(const Command &command) override {
+    done.push_back(command);
+    if (read_after_restore && command.type == CommandType::RESTORE) {
+      queue->enqueue(Command::ReadCommand(), 0);
+    }
+  }
+};
+
+void test_it_should_format_commands(void) {
+  Command range = Command::RangeCommand(300);
+  TEST_ASSERT_EQUAL_STRING("AT+RANGE=300\n", range.c_str());
+  TEST_ASSERT_EQUAL(13, range.length);
+  TEST_ASSERT_EQUAL(300, range.value);
+
+  Command exit = Command::TargetExitBoundaryTimeCommand(1500);
+  TEST_ASSERT_EQUAL_STRING("AT+Exit=15\n", exit.c_str());
+  TEST_ASSERT_EQUAL(1500, exit.value);
+
+  TEST_ASSERT_EQUAL_STRING("AT+XNega=-500\n", Command::XMinCommand(-500).c_str());
+  TEST_ASSERT_EQUAL_STRING("AT+READ\n", Command::ReadCommand().c_str());
+}
+
+void test_it_should_match_replies_by_name(void) {
+  Command range = Command::RangeCommand(300);
+
+  TEST_ASSERT_FALSE(range.matches_reply("OK"));  // Could answer any earlier command
+  TEST_ASSERT_TRUE(range.matches_reply("RANGE=300"));
+  TEST_ASSERT_TRUE(range.matches_reply("range=300"));
+  TEST_ASSERT_FALSE(range.matches_reply("RANGES=300"));
+  TEST_ASSERT_FALSE(range.matches_reply("HEATIME=60"));
+  TEST_ASSERT_TRUE(Command::StartCommand().matches_reply("START"));
+  TEST_ASSERT_FALSE(Command::StartCommand().matches_reply("STOP"));
+  TEST_ASSERT_TRUE(Command::StartCommand().matches_reply("OK"));
+  TEST_ASSERT_FALSE(Command::ReadCommand().matches_reply("OK"));
+}
+
+void test_it_should_send_one_command_at_a_time(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::ResetCommand(), 0);
+  queue.enqueue(Command::SetProtocolModeCommand(PROTOCOL_MODE_DETAILED), 0);
+
+  TEST_ASSERT_EQUAL(1, handler.sent.size());
+  TEST_ASSERT_TRUE(queue.is_waiting());
+
+  TEST_ASSERT_TRUE(queue.handle_reply("OK", 10));
+  TEST_ASSERT_EQUAL(1, handler.done.size());
+  TEST_ASSERT_TRUE(handler.done[0].type == CommandType::RESET);
+  TEST_ASSERT_EQUAL(2, handler.sent.size());
+  TEST_ASSERT_EQUAL_STRING("AT+DEBUG=3\n", handler.sent[1].c_str());
+
+  TEST_ASSERT_TRUE(queue.handle_reply("DEBUG=3", 20));
+  TEST_ASSERT_EQUAL(PROTOCOL_MODE_DETAILED, handler.done[1].value);
+  TEST_ASSERT_EQUAL(0, queue.size());
+  TEST_ASSERT_FALSE(queue.is_waiting());
+}
+
+void test_it_should_ignore_reply_of_other_command(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::RangeCommand(300), 0);
+  queue.enqueue(Command::HeartBeatIntervalCommand(60), 0);
+
+  TEST_ASSERT_FALSE(queue.handle_reply("HEATIME=60", 10));  // Late echo, not for the pending command
+  TEST_ASSERT_EQUAL(0, handler.done.size());
+  TEST_ASSERT_EQUAL(1, handler.sent.size());
+
+  TEST_ASSERT_TRUE(queue.handle_reply("RANGE=300", 20));
+  TEST_ASSERT_TRUE(queue.handle_reply("HEATIME=60", 30));
+  TEST_ASSERT_EQUAL(2, handler.done.size());
+}
+
+void test_it_should_ignore_reply_without_command(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  TEST_ASSERT_FALSE(queue.handle_reply("OK", 0));
+  TEST_ASSERT_EQUAL(0, handler.done.size());
+}
+
+void test_it_should_resend_after_timeout(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::StartCommand(), 1000);
+  queue.loop(1000 + COMMAND_TIMEOUT - 1);
+  TEST_ASSERT_EQUAL(1, handler.sent.size());
+
+  queue.loop(1000 + COMMAND_TIMEOUT);
+  TEST_ASSERT_EQUAL(2, handler.sent.size());
+  TEST_ASSERT_EQUAL_STRING("AT+START\n", handler.sent[1].c_str());
+}
+
+void test_it_should_reject_commands_when_full(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  // The first one is sent right away and leaves the queue
+  for (size_t i = 0; i < COMMAND_QUEUE_SIZE + 1; i++) {
+    TEST_ASSERT_TRUE(queue.enqueue(Command::ReadCommand(), 0));
+  }
+
+  TEST_ASSERT_FALSE(queue.enqueue(Command::StartCommand(), 0));
+  TEST_ASSERT_EQUAL(COMMAND_QUEUE_SIZE, queue.size());
+  TEST_ASSERT_TRUE(queue.enqueue(Command::XMinCommand(-100), 0));  // Writes have their own slots
+}
+
+void test_it_should_back_off_exponentially(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::StartCommand(), 0);
+  uint32_t sent_at = 0;
+  for (uint8_t retry = 1; retry <= COMMAND_RETRIES; retry++) {
+    uint32_t timeout = COMMAND_TIMEOUT << (retry - 1);
+    queue.loop(sent_at + timeout - 1);
+    TEST_ASSERT_EQUAL(retry, handler.sent.size());
+
+    sent_at += timeout;
+    queue.loop(sent_at);
+    TEST_ASSERT_EQUAL(retry + 1, handler.sent.size());
+  }
+
+  TEST_ASSERT_EQUAL(COMMAND_RETRIES, queue.get_stats().retries);
+  TEST_ASSERT_EQUAL(COMMAND_RETRIES + 1, queue.get_stats().sent);
+}
+
+void test_it_should_drop_command_after_last_retry(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::StartCommand().with_retries(1), 0);
+  queue.enqueue(Command::ReadCommand(), 0);
+
+  queue.loop(COMMAND_TIMEOUT);  // Retry
+  queue.loop(COMMAND_TIMEOUT + Command::StartCommand().get_timeout(1));  // Dropped, READ goes out
+
+  TEST_ASSERT_EQUAL(1, handler.failed.size());
+  TEST_ASSERT_TRUE(handler.failed[0].type == CommandType::START);
+  TEST_ASSERT_EQUAL(1, queue.get_stats().failures);
+  TEST_ASSERT_EQUAL(3, handler.sent.size());
+  TEST_ASSERT_EQUAL_STRING("AT+READ\n", handler.sent[2].c_str());
+
+  TEST_ASSERT_FALSE(queue.handle_reply("START", 5000));  // Too late
+  TEST_ASSERT_TRUE(queue.handle_reply("READ", 5000));
+  TEST_ASSERT_FALSE(queue.is_running());
+}
+
+void test_it_should_ignore_stale_ok_after_drop(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::StopCommand().with_retries(0), 0);
+  queue.enqueue(Command::StartCommand(), 0);
+  queue.loop(COMMAND_TIMEOUT);  // STOP dropped, START goes out
+
+  TEST_ASSERT_EQUAL_STRING("AT+START\n", handler.sent[1].c_str());
+  TEST_ASSERT_FALSE(queue.handle_reply("OK", COMMAND_TIMEOUT + 10));  // Late reply to STOP
+  TEST_ASSERT_EQUAL(0, handler.done.size());
+  TEST_ASSERT_TRUE(queue.is_waiting());
+
+  TEST_ASSERT_TRUE(queue.handle_reply("OK", COMMAND_TIMEOUT + 20));
+  TEST_ASSERT_TRUE(handler.done[0].type == CommandType::START);
+}
+
+void test_it_should_take_ok_after_ignoring_one_in_vain(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::StartCommand(), 0);
+  queue.loop(COMMAND_TIMEOUT);  // First send lost, resent
+  TEST_ASSERT_FALSE(queue.handle_reply("OK", COMMAND_TIMEOUT + 10));  // Answers the resend, but may be stale
+
+  queue.loop(COMMAND_TIMEOUT + Command::StartCommand().get_timeout(1));  // Resent again
+  TEST_ASSERT_EQUAL(3, handler.sent.size());
+  TEST_ASSERT_TRUE(queue.handle_reply("OK", 5000));
+  TEST_ASSERT_TRUE(handler.done[0].type == CommandType::START);
+}
+
+void test_it_should_ignore_ok_after_echo(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::StartCommand(), 0);
+  queue.handle_reply("OK", 10);
+  queue.enqueue(Command::XMinCommand(-200), 20);  // Sent between AT+STOP and AT+START
+  queue.handle_reply("OK", 30);
+
+  TEST_ASSERT_EQUAL_STRING("AT+XNega=-200\n", handler.sent.back().c_str());
+  TEST_ASSERT_TRUE(queue.handle_reply("XNega=-200", 40));
+  TEST_ASSERT_EQUAL_STRING("AT+START\n", handler.sent.back().c_str());
+  TEST_ASSERT_FALSE(queue.handle_reply("OK", 50));  // Trailing reply to the write
+  TEST_ASSERT_TRUE(handler.done.back().type == CommandType::X_MIN);
+  TEST_ASSERT_TRUE(queue.is_waiting());
+
+  TEST_ASSERT_TRUE(queue.handle_reply("OK", 60));
+  TEST_ASSERT_TRUE(handler.done.back().type == CommandType::START);
+  TEST_ASSERT_EQUAL_STRING("AT+READ\n", handler.sent.back().c_str());
+}
+
+void test_it_should_use_per_command_timeout(void) {
+  Command reset = Command::ResetCommand();
+  TEST_ASSERT_EQUAL(RESET_COMMAND_TIMEOUT, reset.get_timeout(0));
+  TEST_ASSERT_EQUAL(MAX_COMMAND_TIMEOUT, reset.get_timeout(3));
+  TEST_ASSERT_EQUAL(250, Command::ReadCommand().with_timeout(250).get_timeout(0));
+
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+  queue.enqueue(reset, 0);
+  queue.loop(COMMAND_TIMEOUT);
+  TEST_ASSERT_EQUAL(1, handler.sent.size());
+  queue.loop(RESET_COMMAND_TIMEOUT);
+  TEST_ASSERT_EQUAL(2, handler.sent.size());
+}
+
+// Echoes everything sent until the queue is idle
+void reply_all(CommandQueue &queue, FakeCommandHandler &handler) {
+  for (size_t sent = 0; queue.is_waiting() && sent < 100; sent++) {
+    std::string echo = handler.sent.back().substr(3);  // Without "AT+"
+    echo.pop_back();                                    // and "\n"
+    queue.handle_reply(echo.c_str(), 0);
+  }
+}
+
+void test_it_should_send_only_latest_value_of_write(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::ReadCommand(), 0);  // Keeps the queue busy while the slider moves
+  for (int x_min = -100; x_min >= -300; x_min -= 10) {
+    queue.enqueue(Command::XMinCommand(x_min), 0);
+  }
+  queue.enqueue(Command::InstallationHeightCommand(200), 0);
+  queue.enqueue(Command::InstallationHeightCommand(250), 0);
+  TEST_ASSERT_EQUAL(2, queue.size());
+
+  reply_all(queue, handler);
+
+  std::vector<std::string> expected{"AT+READ\n", "AT+HEIGHTD=250\n", "AT+XNega=-300\n", "AT+READ\n"};
+  TEST_ASSERT_EQUAL(expected.size(), handler.sent.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), handler.sent[i].c_str());
+  }
+}
+
+void test_it_should_bracket_writes_while_running(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::StartCommand(), 0);
+  queue.enqueue(Command::XMinCommand(-200), 0);
+  queue.enqueue(Command::YMaxCommand(300), 0);
+  reply_all(queue, handler);
+
+  std::vector<std::string> expected{"AT+START\n", "AT+STOP\n",  "AT+XNega=-200\n",
+                                    "AT+YPosi=300\n", "AT+START\n", "AT+READ\n"};
+  TEST_ASSERT_EQUAL(expected.size(), handler.sent.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), handler.sent[i].c_str());
+  }
+  TEST_ASSERT_TRUE(queue.is_running());
+}
+
+void test_it_should_add_write_to_running_batch(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::XMinCommand(-200), 0);  // Sent right away, the batch is open
+  queue.enqueue(Command::XMinCommand(-300), 0);  // Already sent, so written again in the same batch
+  reply_all(queue, handler);
+
+  std::vector<std::string> expected{"AT+XNega=-200\n", "AT+XNega=-300\n", "AT+READ\n"};
+  TEST_ASSERT_EQUAL(expected.size(), handler.sent.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), handler.sent[i].c_str());
+  }
+}
+
+// Answers everything sent like the radar does, with the echo and then "OK", until the queue is idle. Each answer has to
+// complete the command it answers, and nothing else.
+void reply_all_with_ok(CommandQueue &queue, FakeCommandHandler &handler) {
+  for (size_t sent = 0; queue.is_waiting() && sent < 100; sent++) {
+    std::string command = handler.sent.back();
+    std::string echo = command.substr(3, command.size() - 4);
+    size_t done = handler.done.size();
+
+    queue.handle_reply(echo.c_str(), 0);
+    queue.handle_reply("OK", 0);
+    TEST_ASSERT_EQUAL(done + 1, handler.done.size());
+    TEST_ASSERT_EQUAL_STRING(command.c_str(), handler.done.back().c_str());
+  }
+}
+
+void test_it_should_complete_batch_on_radar_replies(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+
+  queue.enqueue(Command::SetProtocolModeCommand(PROTOCOL_MODE_DETAILED), 0);
+  queue.enqueue(Command::StartCommand(), 0);
+  queue.enqueue(Command::XMinCommand(-200), 0);
+  queue.enqueue(Command::YMaxCommand(300), 0);
+  reply_all_with_ok(queue, handler);
+  queue.enqueue(Command::RangeCommand(400), 0);  // STOP right after READ
+  reply_all_with_ok(queue, handler);
+
+  std::vector<std::string> expected{"AT+DEBUG=3\n", "AT+START\n",  "AT+STOP\n",      "AT+XNega=-200\n",
+                                    "AT+YPosi=300\n", "AT+START\n", "AT+READ\n",       "AT+STOP\n",
+                                    "AT+RANGE=400\n", "AT+START\n", "AT+READ\n"};
+  TEST_ASSERT_EQUAL(expected.size(), handler.sent.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), handler.sent[i].c_str());
+  }
+  TEST_ASSERT_EQUAL(expected.size(), handler.done.size());
+  TEST_ASSERT_TRUE(queue.is_running());
+}
+
+void test_it_should_allow_enqueue_from_completion(void) {
+  FakeCommandHandler handler;
+  CommandQueue queue(handler);
+  handler.queue = &queue;
+  handler.read_after_restore = true;
+
+  queue.enqueue(Command::RestoreCommand(), 0);
+  queue.handle_reply("RESTORE", 10);
+
+  TEST_ASSERT_EQUAL(2, handler.sent.size());
+  TEST_ASSERT_EQUAL_STRING("AT+READ\n", handler.sent[1].c_str());
+  TEST_ASSERT_TRUE(queue.handle_reply("READ", 20));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_format_commands);
+  RUN_TEST(test_it_should_match_replies_by_name);
+  RUN_TEST(test_it_should_send_one_command_at_a_time);
+  RUN_TEST(test_it_should_ignore_reply_of_other_command);
+  RUN_TEST(test_it_should_ignore_reply_without_command);
+  RUN_TEST(test_it_should_resend_after_timeout);
+  RUN_TEST(test_it_should_back_off_exponentially);
+  RUN_TEST(test_it_should_drop_command_after_last_retry);
+  RUN_TEST(test_it_should_ignore_stale_ok_after_drop);
+  RUN_TEST(test_it_should_take_ok_after_ignoring_one_in_vain);
+  RUN_TEST(test_it_should_ignore_ok_after_echo);
+  RUN_TEST(test_it_should_use_per_command_timeout);
+  RUN_TEST(test_it_should_reject_commands_when_full);
+  RUN_TEST(test_it_should_send_only_latest_value_of_write);
+  RUN_TEST(test_it_should_bracket_writes_while_running);
+  RUN_TEST(test_it_should_add_write_to_running_batch);
+  RUN_TEST(test_it_should_complete_batch_on_radar_replies);
+  RUN_TEST(test_it_should_allow_enqueue_from_completion);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
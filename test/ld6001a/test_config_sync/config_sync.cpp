@@ -0,0 +1,101 @@
+#include "unity.h"
+#include <string>
+#include <vector>
+#include "ld6001a/config_sync.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+ReadParamsResponse make_params() {
+  ReadParamsResponse params{};
+  params.range = 300;
+  params.range_sensitivity = 5;
+  params.heart_beat_interval = 60;
+  params.protocol_mode = PROTOCOL_MODE_DETAILED;
+  params.detection_height = 280;
+  params.x_nega = -250;
+  params.x_posi = 250;
+  params.y_nega = -250;
+  params.y_posi = 250;
+  params.moving_target_disappearance_time = 5.0f;
+  params.static_target_disappearance_time = 60.0f;
+  params.target_exit_time = 1.0f;
+  return params;
+}
+
+std::vector<std::string> diff(const ConfigSync &sync, const ReadParamsResponse &params) {
+  std::vector<std::string> writes;
+  sync.diff(params, [&](const Command &command) { writes.push_back(command.c_str()); });
+  return writes;
+}
+
+void test_it_should_write_nothing_without_parameters(void) {
+  ConfigSync sync;
+  TEST_ASSERT_TRUE(sync.empty());
+  TEST_ASSERT_EQUAL(0, diff(sync, make_params()).size());
+}
+
+void test_it_should_write_nothing_when_in_sync(void) {
+  ConfigSync sync;
+  sync.set(CommandType::RANGE, 300);
+  sync.set(CommandType::X_MIN, -250);
+  sync.set(CommandType::MOVING_TARGET_DISAPPEARANCE_TIME, 5000);
+  sync.set(CommandType::EXIT_BOUNDARY_TIME, 1000);
+
+  TEST_ASSERT_FALSE(sync.empty());
+  TEST_ASSERT_EQUAL(0, diff(sync, make_params()).size());
+}
+
+void test_it_should_write_only_differing_parameters(void) {
+  ConfigSync sync;
+  sync.set(CommandType::RANGE, 300);
+  sync.set(CommandType::INSTALLATION_HEIGHT, 250);
+  sync.set(CommandType::Y_MAX, 250);
+  sync.set(CommandType::STATIC_TARGET_DISAPPEARANCE_TIME, 30000);
+
+  std::vector<std::string> expected{"AT+HEIGHTD=250\n", "AT+Static=300\n"};
+  TEST_ASSERT_TRUE(expected == diff(sync, make_params()));
+  TEST_ASSERT_EQUAL(2, sync.diff(make_params(), [](const Command &command) {}));
+}
+
+void test_it_should_compare_times_in_ms(void) {
+  ReadParamsResponse params = make_params();
+  params.target_exit_time = 0.3f;  // Not exactly representable
+
+  ConfigSync sync;
+  sync.set(CommandType::EXIT_BOUNDARY_TIME, 300);
+  TEST_ASSERT_EQUAL(0, diff(sync, params).size());
+
+  sync.set(CommandType::EXIT_BOUNDARY_TIME, 400);
+  std::vector<std::string> expected{"AT+Exit=4\n"};
+  TEST_ASSERT_TRUE(expected == diff(sync, params));
+}
+
+void test_it_should_keep_latest_value(void) {
+  ConfigSync sync;
+  sync.set(CommandType::X_MAX, 200);
+  sync.set(CommandType::X_MAX, 400);
+
+  std::vector<std::string> expected{"AT+XPosi=400\n"};
+  TEST_ASSERT_TRUE(expected == diff(sync, make_params()));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_write_nothing_without_parameters);
+  RUN_TEST(test_it_should_write_nothing_when_in_sync);
+  RUN_TEST(test_it_should_write_only_differing_parameters);
+  RUN_TEST(test_it_should_compare_times_in_ms);
+  RUN_TEST(test_it_should_keep_latest_value);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
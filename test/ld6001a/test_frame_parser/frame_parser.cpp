@@ -5,7 +5,6 @@
 #include <vector>
 #include "ld6001a/frame_parser.h"  // Include the header file for the class being tested
 
-#include "esphome/components/json/json_util.cpp" // Ugly, but otherwise the test fails to compile with "undefined reference to `esphome::json::parse_json(std::string const&, esphome::json::json_parse_t const&)'"
 #include <ArduinoFake.h>
 
 using namespace esphome::ld6001a;
@@ -45,6 +44,27 @@ void test_it_should_accept_at_ok(void) {
   TEST_ASSERT_EQUAL(true, handler.on_ack_response_called);
 }
 
+void test_it_should_pass_at_reply_text(void) {
+  class InlineFrameHandler : public FrameHandler {
+    public:
+      std::vector<std::string> replies;
+
+      void on_at_reply(const char *reply) override {
+        replies.push_back(reply);
+      }
+  };
+
+  InlineFrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  const char chunk[] = "AT+RANGE=300\r\nAT+OK\r\n";
+  frame_iterator.push_data(reinterpret_cast<const uint8_t *>(chunk), sizeof(chunk) - 1);
+
+  TEST_ASSERT_EQUAL(2, handler.replies.size());
+  TEST_ASSERT_EQUAL_STRING("RANGE=300", handler.replies[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("OK", handler.replies[1].c_str());
+}
+
 void test_it_should_skip_unknown_bytes(void) {
   class InlineFrameHandler : public FrameHandler {
     public:
@@ -111,8 +131,8 @@ void test_it_should_accept_binary_type2(void) {
     public:
       std::vector<Person> people;
 
-      void on_detailed_radar_response(const std::vector<Person> people) override {
-        this->people = people;
+      void on_detailed_radar_response(Span<Person> people) override {
+        this->people.assign(people.begin(), people.end());
       }
   };
 
@@ -187,14 +207,122 @@ void test_it_should_validate_checksum(void) {
   TEST_ASSERT_EQUAL(ParseState::INVALID, frame_iterator.state_);
 }
 
+void test_it_should_parse_multiple_frames_from_one_chunk(void) {
+  class InlineFrameHandler : public FrameHandler {
+    public:
+      int acks = 0;
+      int people_counted = -1;
+
+      void on_ack_response() override {
+        acks++;
+      }
+
+      void on_simple_radar_response(const uint8_t people_counted) override {
+        this->people_counted = people_counted;
+      }
+  };
+
+  InlineFrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  const uint8_t chunk[] = {
+    'A', 'T', '+', 'O', 'K', '\r', '\n',
+    0x55, 0xAA, 0x0A, 0x04, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0D,
+    'A', 'T', '+', 'O', 'K', '\r', '\n',
+  };
+  frame_iterator.push_data(chunk, sizeof(chunk));
+
+  TEST_ASSERT_EQUAL(2, handler.acks);
+  TEST_ASSERT_EQUAL(3, handler.people_counted);
+  TEST_ASSERT_EQUAL(ParseState::IDLE, frame_iterator.state_);
+}
+
+void test_it_should_accept_save_para_fail(void) {
+  class InlineFrameHandler : public FrameHandler {
+    public:
+      int save_param_failed = 0;
+      int acks = 0;
+
+      void on_save_param_failed() override {
+        save_param_failed++;
+      }
+
+      void on_ack_response() override {
+        acks++;
+      }
+  };
+
+  InlineFrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  const char chunk[] = "Save Para Fail\r\nAT+OK\r\n";
+  frame_iterator.push_data(reinterpret_cast<const uint8_t *>(chunk), sizeof(chunk) - 1);
+
+  TEST_ASSERT_EQUAL(1, handler.save_param_failed);
+  TEST_ASSERT_EQUAL(1, handler.acks);
+  TEST_ASSERT_EQUAL(0, frame_iterator.get_stats().bytes_discarded);
+  TEST_ASSERT_EQUAL(ParseState::IDLE, frame_iterator.state_);
+}
+
+void test_it_should_summarize_resyncs(void) {
+  FrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  const uint8_t chunk[] = {
+    0x00, 0xFF, 'x', 'A', 'X', 0x13,
+    'A', 'T', '+', 'O', 'K', '\r', '\n',
+  };
+  frame_iterator.push_data(chunk, sizeof(chunk));
+
+  const ResyncSummary &resync = frame_iterator.get_last_resync();
+  TEST_ASSERT_EQUAL(6, resync.skipped);
+  TEST_ASSERT_EQUAL(6, resync.sample_len);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(chunk, resync.sample.data(), 6);
+  TEST_ASSERT_EQUAL(1, frame_iterator.get_stats().resyncs);
+  TEST_ASSERT_EQUAL(1, frame_iterator.get_stats().get_frames(FrameType::ACK));
+
+  // Only the first bytes of a long run are kept
+  std::vector<uint8_t> garbage(40, 0xEE);
+  frame_iterator.push_data(garbage.data(), garbage.size());
+  frame_iterator.push_data(chunk + 6, sizeof(chunk) - 6);
+
+  TEST_ASSERT_EQUAL(40, resync.skipped);
+  TEST_ASSERT_EQUAL(ResyncSummary::SAMPLE_SIZE, resync.sample_len);
+  TEST_ASSERT_EQUAL(2, frame_iterator.get_stats().resyncs);
+  TEST_ASSERT_EQUAL(46, frame_iterator.get_stats().bytes_discarded);
+}
+
+void test_it_should_parse_chunk_larger_than_buffer(void) {
+  FrameHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  // Garbage runs around frames, more than the parser buffers at once
+  const char ok[] = "AT+OK\r\n";
+  std::vector<uint8_t> chunk;
+  for (int i = 0; i < 3; i++) {
+    chunk.insert(chunk.end(), 1500, 0xEE);
+    chunk.insert(chunk.end(), ok, ok + sizeof(ok) - 1);
+  }
+  frame_iterator.push_data(chunk.data(), chunk.size());
+
+  TEST_ASSERT_EQUAL(3, frame_iterator.get_stats().get_frames(FrameType::ACK));
+  TEST_ASSERT_EQUAL(4500, frame_iterator.get_stats().bytes_discarded);
+  TEST_ASSERT_EQUAL(0, frame_iterator.get_stats().buffer_overflows);
+}
+
 int runUnityTests(void) {
   UNITY_BEGIN();
   RUN_TEST(test_parser_should_start_in_idle_state);
+  RUN_TEST(test_it_should_pass_at_reply_text);
   RUN_TEST(test_it_should_skip_unknown_bytes);
   RUN_TEST(test_it_should_accept_at_ok);
   RUN_TEST(test_it_should_accept_binary_type1);
   RUN_TEST(test_it_should_accept_binary_type2);
   RUN_TEST(test_it_should_validate_checksum);
+  RUN_TEST(test_it_should_parse_multiple_frames_from_one_chunk);
+  RUN_TEST(test_it_should_accept_save_para_fail);
+  RUN_TEST(test_it_should_summarize_resyncs);
+  RUN_TEST(test_it_should_parse_chunk_larger_than_buffer);
   return UNITY_END();
 }
 
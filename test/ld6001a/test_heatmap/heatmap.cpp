@@ -0,0 +1,114 @@
+#include "unity.h"
+#include <vector>
+#include "ld6001a/heatmap.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+void test_it_should_size_grid_by_cell_size(void) {
+  Heatmap heatmap;
+
+  TEST_ASSERT_TRUE(heatmap.configure(-100, -50, 110, 50, 25));
+  TEST_ASSERT_EQUAL(9, heatmap.get_columns());  // 210cm rounded up to whole cells
+  TEST_ASSERT_EQUAL(4, heatmap.get_rows());
+  TEST_ASSERT_EQUAL(0, heatmap.get(8, 3));
+}
+
+void test_it_should_reject_invalid_grids(void) {
+  Heatmap heatmap;
+
+  TEST_ASSERT_FALSE(heatmap.configure(0, 0, 100, 100, 0));
+  TEST_ASSERT_FALSE(heatmap.configure(100, 0, 0, 100, 10));
+  TEST_ASSERT_FALSE(heatmap.configure(-1000, -1000, 1000, 1000, 10));  // 40000 cells
+  TEST_ASSERT_FALSE(heatmap.is_configured());
+}
+
+void test_it_should_count_targets_in_cells(void) {
+  Heatmap heatmap;
+  heatmap.configure(-100, -100, 100, 100, 50);
+
+  heatmap.add(-100, -100);
+  heatmap.add(-51, -51);
+  heatmap.add(0, 0);
+  heatmap.add(99, 60);
+  heatmap.add(100, 0);   // Right edge, outside
+  heatmap.add(-101, 0);  // Outside
+
+  TEST_ASSERT_EQUAL(2, heatmap.get(0, 0));
+  TEST_ASSERT_EQUAL(1, heatmap.get(2, 2));
+  TEST_ASSERT_EQUAL(1, heatmap.get(3, 3));
+  TEST_ASSERT_EQUAL(0, heatmap.get(3, 2));
+}
+
+void test_it_should_saturate_bins(void) {
+  Heatmap heatmap;
+  heatmap.configure(0, 0, 10, 10, 10);
+
+  for (uint32_t i = 0; i < UINT16_MAX + 10; i++) {
+    heatmap.add(5, 5);
+  }
+
+  TEST_ASSERT_EQUAL(UINT16_MAX, heatmap.get(0, 0));
+}
+
+void test_it_should_decay_bins(void) {
+  Heatmap heatmap;
+  heatmap.configure(0, 0, 20, 10, 10);
+  for (int i = 0; i < 100; i++) {
+    heatmap.add(5, 5);
+  }
+  heatmap.add(15, 5);
+
+  heatmap.decay(0.5f);
+  TEST_ASSERT_EQUAL(50, heatmap.get(0, 0));
+  TEST_ASSERT_EQUAL(0, heatmap.get(1, 0));  // Rounded down so stale cells fade out
+
+  heatmap.decay(1.0f);
+  TEST_ASSERT_EQUAL(50, heatmap.get(0, 0));
+
+  heatmap.clear();
+  TEST_ASSERT_EQUAL(0, heatmap.get(0, 0));
+}
+
+void test_it_should_encode_blob(void) {
+  Heatmap heatmap;
+  heatmap.configure(-20, -10, 20, 10, 20);
+  heatmap.add(-20, -10);
+  for (int i = 0; i < 0x102; i++) {
+    heatmap.add(10, 5);
+  }
+
+  auto data = heatmap.encode();
+  const uint8_t expected[] = {
+      'L',  'D',  'H',  HEATMAP_VERSION,
+      0xEC, 0xFF,              // x -20
+      0xF6, 0xFF,              // y -10
+      20,   0,                 // cell size
+      2,    0,    1,    0,     // 2x1 cells
+      1,    0,    0x02, 0x01,  // bins
+  };
+
+  TEST_ASSERT_EQUAL(HEATMAP_HEADER_SIZE + 4, data.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data.data(), sizeof(expected));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_size_grid_by_cell_size);
+  RUN_TEST(test_it_should_reject_invalid_grids);
+  RUN_TEST(test_it_should_count_targets_in_cells);
+  RUN_TEST(test_it_should_saturate_bins);
+  RUN_TEST(test_it_should_decay_bins);
+  RUN_TEST(test_it_should_encode_blob);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
@@ -0,0 +1,199 @@
+#define UNITY_INCLUDE_PRINT_FORMATTED 1
+
+#include "unity.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ld6001a/frame_event_queue.h"  // Include the header file for the class being tested
+#include "ld6001a/parser_stats.h"
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+// Detailed frame where every person carries the sequence number as id and x coordinate
+std::vector<uint8_t> build_detailed_frame(uint32_t sequence, size_t people) {
+  std::vector<uint8_t> frame = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+  auto push_uint32 = [&frame](uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+      frame.push_back((value >> (i * 8)) & 0xFF);
+    }
+  };
+  auto push_float = [&push_uint32](float value) {
+    uint32_t u;
+    std::memcpy(&u, &value, sizeof(float));
+    push_uint32(u);
+  };
+
+  push_uint32(32 + people * 32);
+  push_uint32(0x01A3);
+  push_uint32(1);
+  push_uint32(0);
+  push_uint32(2);
+  push_uint32(people * 32);
+
+  for (size_t i = 0; i < people; i++) {
+    push_uint32(0);
+    push_uint32(sequence);
+    push_float(sequence);
+    for (int j = 0; j < 5; j++) {
+      push_float(0.5f);
+    }
+  }
+
+  uint8_t checksum = 0;
+  for (size_t i = 12; i < 16; i++) {
+    checksum ^= frame[i];
+  }
+  for (size_t i = 32; i < frame.size(); i++) {
+    checksum ^= frame[i];
+  }
+  frame.push_back(checksum);
+
+  return frame;
+}
+
+class CheckingFrameHandler : public FrameHandler {
+  public:
+    uint32_t frames = 0;
+    uint32_t acks = 0;
+    uint32_t torn = 0;
+    uint32_t out_of_order = 0;
+    int64_t last_sequence = -1;
+
+    void on_ack_response() override {
+      acks++;
+    }
+
+    void on_detailed_radar_response(Span<Person> people) override {
+      frames++;
+
+      if (people.empty()) {
+        torn++;
+        return;
+      }
+
+      int64_t sequence = people[0].id;
+      if (sequence <= last_sequence) {
+        out_of_order++;
+      }
+      last_sequence = sequence;
+
+      for (const auto &person : people) {
+        if (person.id != sequence || person.x != static_cast<float>(sequence)) {
+          torn++;
+        }
+      }
+    }
+};
+
+void test_events_should_cross_threads_intact_and_in_order(void) {
+  static const uint32_t FRAMES = 2000;
+
+  FrameEventQueue<8> events;
+  CheckingFrameHandler handler;
+  std::atomic<bool> done{false};
+
+  // Stand-in for the parser task: parse the UART stream and queue the results
+  std::thread parser_task([&events, &done]() {
+    FrameParser parser(events);
+    const uint8_t ack[] = {'A', 'T', '+', 'O', 'K', '\r', '\n'};
+
+    for (uint32_t sequence = 0; sequence < FRAMES; sequence++) {
+      auto frame = build_detailed_frame(sequence, 1 + sequence % MAX_TARGETS);
+
+      // Deliver the frame in UART sized chunks
+      for (size_t offset = 0; offset < frame.size(); offset += 64) {
+        parser.push_data(frame.data() + offset, std::min<size_t>(64, frame.size() - offset));
+      }
+
+      if (sequence % 10 == 0) {
+        parser.push_data(ack, sizeof(ack));
+      }
+
+      if (sequence % 4 == 0) {
+        std::this_thread::yield();
+      }
+    }
+
+    done = true;
+  });
+
+  // Stand-in for loop()
+  while (!done) {
+    events.dispatch(handler);
+  }
+  parser_task.join();
+  events.dispatch(handler);
+
+  TEST_ASSERT_EQUAL(0, handler.torn);
+  TEST_ASSERT_EQUAL(0, handler.out_of_order);
+  TEST_ASSERT_GREATER_THAN(0, handler.frames);
+  TEST_ASSERT_EQUAL(FRAMES + FRAMES / 10, handler.frames + handler.acks + events.get_dropped());
+}
+
+void test_queue_should_drop_when_the_consumer_falls_behind(void) {
+  FrameEventQueue<4> events;
+  CheckingFrameHandler handler;
+  FrameParser parser(events);
+
+  for (uint32_t sequence = 0; sequence < 6; sequence++) {
+    auto frame = build_detailed_frame(sequence, 1);
+    parser.push_data(frame.data(), frame.size());
+  }
+
+  TEST_ASSERT_EQUAL(4, events.dispatch(handler));
+  TEST_ASSERT_EQUAL(2, events.get_dropped());
+  TEST_ASSERT_EQUAL(3, handler.last_sequence);
+}
+
+void test_ingest_stats_should_not_lose_times_across_threads(void) {
+  const uint32_t TIMES = 200000;
+  IngestStats stats;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < TIMES; i++) {
+      stats.add(i % 100 + 1);
+    }
+    done = true;
+  });
+
+  // Every interval taken pairs its total with its own count, so each one averages within the added range
+  uint64_t count = 0;
+  uint64_t total = 0;
+  auto take = [&]() {
+    auto interval = stats.take();
+    if (interval.count > 0) {
+      TEST_ASSERT_GREATER_OR_EQUAL(1, interval.get_average_us());
+      TEST_ASSERT_LESS_OR_EQUAL(100, interval.get_average_us());
+      TEST_ASSERT_LESS_OR_EQUAL(100, interval.max_us);
+    }
+    count += interval.count;
+    total += interval.total_us;
+  };
+  while (!done) {
+    take();
+  }
+  producer.join();
+  take();
+
+  TEST_ASSERT_EQUAL(TIMES, count);
+  TEST_ASSERT_EQUAL(uint64_t(TIMES / 100) * 5050, total);
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_events_should_cross_threads_intact_and_in_order);
+  RUN_TEST(test_queue_should_drop_when_the_consumer_falls_behind);
+  RUN_TEST(test_ingest_stats_should_not_lose_times_across_threads);
+  return UNITY_END();
+}
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { 
+  return runUnityTests(); 
+}
@@ -0,0 +1,85 @@
+#include "unity.h"
+#include "ld6001a/publish_filter.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+void test_it_should_publish_first_value(void) {
+  PublishFilter filter;
+  filter.configure(10, 0);
+
+  TEST_ASSERT_TRUE(filter.update(42, 0));
+}
+
+void test_it_should_not_publish_unchanged_value(void) {
+  PublishFilter filter;
+  filter.configure(0, 1000);
+
+  TEST_ASSERT_TRUE(filter.update(42, 0));
+  TEST_ASSERT_FALSE(filter.update(42, 100));
+  TEST_ASSERT_FALSE(filter.update(42, 5000));
+}
+
+void test_it_should_publish_changes_above_min_delta(void) {
+  PublishFilter filter;
+  filter.configure(10, 0);
+
+  TEST_ASSERT_TRUE(filter.update(100, 0));
+  TEST_ASSERT_FALSE(filter.update(105, 10));
+  TEST_ASSERT_FALSE(filter.update(95, 20));
+  TEST_ASSERT_TRUE(filter.update(110, 30));
+  // The delta is measured against the last published value, not the last seen one
+  TEST_ASSERT_FALSE(filter.update(101, 40));
+  TEST_ASSERT_TRUE(filter.update(100, 50));
+}
+
+void test_it_should_publish_small_changes_after_max_interval(void) {
+  PublishFilter filter;
+  filter.configure(10, 1000);
+
+  TEST_ASSERT_TRUE(filter.update(100, 0));
+  TEST_ASSERT_FALSE(filter.update(102, 999));
+  TEST_ASSERT_TRUE(filter.update(102, 1000));
+  TEST_ASSERT_FALSE(filter.update(104, 1500));
+  TEST_ASSERT_TRUE(filter.update(104, 2000));
+}
+
+void test_it_should_handle_millis_overflow(void) {
+  PublishFilter filter;
+  filter.configure(10, 1000);
+
+  TEST_ASSERT_TRUE(filter.update(100, UINT32_MAX - 500));
+  TEST_ASSERT_FALSE(filter.update(102, 400));
+  TEST_ASSERT_TRUE(filter.update(102, 500));
+}
+
+void test_it_should_always_publish_target_leaving_and_returning(void) {
+  PublishFilter filter;
+  filter.configure(10, 0);
+
+  TEST_ASSERT_TRUE(filter.update(100, 0));
+  TEST_ASSERT_TRUE(filter.update(NAN, 10));
+  TEST_ASSERT_FALSE(filter.update(NAN, 20));
+  TEST_ASSERT_TRUE(filter.update(101, 30));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_publish_first_value);
+  RUN_TEST(test_it_should_not_publish_unchanged_value);
+  RUN_TEST(test_it_should_publish_changes_above_min_delta);
+  RUN_TEST(test_it_should_publish_small_changes_after_max_interval);
+  RUN_TEST(test_it_should_handle_millis_overflow);
+  RUN_TEST(test_it_should_always_publish_target_leaving_and_returning);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
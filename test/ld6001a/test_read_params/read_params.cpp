@@ -0,0 +1,192 @@
+#define UNITY_INCLUDE_PRINT_FORMATTED 1
+
+#include "unity.h"
+#include <string>
+#include "ld6001a/frame_parser.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+// AT+READ reply of a module running NOP_1.07-01. Lines end in a tab and a line feed, the last three keys use a GBK
+// full-width colon and a unit.
+static const std::string READ_RESPONSE_NOP_1_07 =
+    "{\x09\x0a"
+    "\"PeopleCntSoftVerison\":NOP_1.07-01,\x09\x0a"
+    "\"RangeRes\":0.084,\x09\x0a"
+    "\"VelRes\":0.095,\x09\x0a"
+    "\"TIME\":50,\x09\x0a"
+    "\"PROG\":02,\x09\x0a"
+    "\"Range\":300,\x09\x0a"
+    "\"Sen\":4,\x09\x0a"
+    "\"Heart_Time\":60,\x09\x0a"
+    "\"Debug\":3,\x09\x0a"
+    "\"XboundaryN\":-250,\x09\x0a"
+    "\"XboundaryP\":260,\x09\x0a"
+    "\"YboundaryN\":-270,\x09\x0a"
+    "\"YboundaryP\":280,\x09\x0a"
+    "\"detectionHeight\":290,\x09\x0a"
+    "Moving target\xa3\xba" "5.0s,\x09\x0a"
+    "Static target\xa3\xba" "60.0s,\x09\x0a"
+    "Target exit\xa3\xba" "1.5s\x09\x0a"
+    "}";
+
+// Firmware before NOP_1.07 names some keys differently and stops after the last value without a closing brace
+static const std::string READ_RESPONSE_OLD =
+    "{\x09\x0a"
+    "\"SoftwareVersion\":NOP_1.05,\x09\x0a"
+    "\"RangeRes\":0.084,\x09\x0a"
+    "\"VelRes\":0.095,\x09\x0a"
+    "\"Time\":40,\x09\x0a"
+    "\"Prog\":01,\x09\x0a"
+    "\"Range\":400,\x09\x0a"
+    "\"Sen\":7,\x09\x0a"
+    "\"Heart_Time\":30,\x09\x0a"
+    "\"Debug\":3,\x09\x0a"
+    "\"XboundaryN\":-300,\x09\x0a"
+    "\"XboundaryP\":300,\x09\x0a"
+    "\"YboundaryN\":-300,\x09\x0a"
+    "\"YboundaryP\":300,\x09\x0a"
+    "\"detectionHeight\":250,\x09\x0a"
+    "Moving target\xa3\xba" "10.0s,\x09\x0a"
+    "Static target\xa3\xba" "120.0s,\x09\x0a"
+    "Target exit\xa3\xba" "2.0s,";
+
+class ReadParamsHandler : public FrameHandler {
+ public:
+  int acks = 0;
+  int responses = 0;
+  ReadParamsResponse response{};
+
+  void on_ack_response() override { this->acks++; }
+
+  void on_read_params_response(const ReadParamsResponse response) override {
+    this->responses++;
+    this->response = response;
+  }
+};
+
+void push_string(FrameParser &parser, const std::string &data) {
+  parser.push_data(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+void test_it_should_parse_read_response(void) {
+  ReadParamsHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+  push_string(frame_iterator, READ_RESPONSE_NOP_1_07);
+
+  TEST_ASSERT_EQUAL(1, handler.responses);
+  TEST_ASSERT_EQUAL(1, handler.acks);
+  TEST_ASSERT_EQUAL_STRING("NOP_1.07-01", handler.response.software_version.data());
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.084, handler.response.range_res);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.095, handler.response.vel_res);
+  TEST_ASSERT_EQUAL(50, handler.response.time);
+  TEST_ASSERT_EQUAL(2, handler.response.prog);
+  TEST_ASSERT_EQUAL(300, handler.response.range);
+  TEST_ASSERT_EQUAL(4, handler.response.range_sensitivity);
+  TEST_ASSERT_EQUAL(60, handler.response.heart_beat_interval);
+  TEST_ASSERT_EQUAL(3, handler.response.protocol_mode);
+  TEST_ASSERT_EQUAL(-250, handler.response.x_nega);
+  TEST_ASSERT_EQUAL(260, handler.response.x_posi);
+  TEST_ASSERT_EQUAL(-270, handler.response.y_nega);
+  TEST_ASSERT_EQUAL(280, handler.response.y_posi);
+  TEST_ASSERT_EQUAL(290, handler.response.detection_height);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 5.0, handler.response.moving_target_disappearance_time);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 60.0, handler.response.static_target_disappearance_time);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.5, handler.response.target_exit_time);
+
+  TEST_ASSERT_EQUAL(0, frame_iterator.get_stats().bytes_discarded);
+  TEST_ASSERT_EQUAL(ParseState::IDLE, frame_iterator.state_);
+}
+
+void test_it_should_parse_read_response_of_old_firmware(void) {
+  ReadParamsHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+  push_string(frame_iterator, READ_RESPONSE_OLD);
+
+  TEST_ASSERT_EQUAL(1, handler.responses);
+  TEST_ASSERT_EQUAL_STRING("NOP_1.05", handler.response.software_version.data());
+  TEST_ASSERT_EQUAL(40, handler.response.time);
+  TEST_ASSERT_EQUAL(1, handler.response.prog);
+  TEST_ASSERT_EQUAL(400, handler.response.range);
+  TEST_ASSERT_EQUAL(7, handler.response.range_sensitivity);
+  TEST_ASSERT_EQUAL(250, handler.response.detection_height);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 10.0, handler.response.moving_target_disappearance_time);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 120.0, handler.response.static_target_disappearance_time);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 2.0, handler.response.target_exit_time);
+  TEST_ASSERT_EQUAL(ParseState::IDLE, frame_iterator.state_);
+}
+
+void test_it_should_parse_read_response_byte_by_byte(void) {
+  ReadParamsHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  for (char c : READ_RESPONSE_NOP_1_07 + "AT+OK\r\n") {
+    frame_iterator.push_data(static_cast<uint8_t>(c));
+  }
+
+  TEST_ASSERT_EQUAL(1, handler.responses);
+  TEST_ASSERT_EQUAL(2, handler.acks);
+  TEST_ASSERT_EQUAL(290, handler.response.detection_height);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.5, handler.response.target_exit_time);
+  TEST_ASSERT_EQUAL(0, frame_iterator.get_stats().bytes_discarded);
+}
+
+void test_it_should_hand_over_after_old_read_response(void) {
+  ReadParamsHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+  push_string(frame_iterator, READ_RESPONSE_OLD + "AT+OK\r\n");
+
+  TEST_ASSERT_EQUAL(1, handler.responses);
+  TEST_ASSERT_EQUAL(2, handler.acks);
+  TEST_ASSERT_EQUAL(0, frame_iterator.get_stats().bytes_discarded);
+}
+
+void test_it_should_wait_for_brace_when_chunk_ends_after_last_value(void) {
+  ReadParamsHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+  std::string response = READ_RESPONSE_NOP_1_07;
+  response.replace(response.rfind("1.5s"), std::string::npos, "1.5s,\r\n}");
+  const size_t split = response.size() - 1;
+
+  frame_iterator.push_data(reinterpret_cast<const uint8_t *>(response.data()), split);
+  TEST_ASSERT_EQUAL(0, handler.responses);
+
+  frame_iterator.push_data(reinterpret_cast<const uint8_t *>(response.data()) + split, response.size() - split);
+  TEST_ASSERT_EQUAL(1, handler.responses);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.5, handler.response.target_exit_time);
+  TEST_ASSERT_EQUAL(0, frame_iterator.get_stats().bytes_discarded);
+  TEST_ASSERT_EQUAL(ParseState::IDLE, frame_iterator.state_);
+}
+
+void test_it_should_reject_binary_data_after_brace(void) {
+  ReadParamsHandler handler;
+  FrameParser frame_iterator = FrameParser(handler);
+
+  const uint8_t chunk[] = {'{', 0x00, 0x13, 'A', 'T', '+', 'O', 'K', '\r', '\n'};
+  frame_iterator.push_data(chunk, sizeof(chunk));
+
+  TEST_ASSERT_EQUAL(0, handler.responses);
+  TEST_ASSERT_EQUAL(1, handler.acks);
+  TEST_ASSERT_EQUAL(3, frame_iterator.get_stats().bytes_discarded);
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_parse_read_response);
+  RUN_TEST(test_it_should_parse_read_response_of_old_firmware);
+  RUN_TEST(test_it_should_parse_read_response_byte_by_byte);
+  RUN_TEST(test_it_should_hand_over_after_old_read_response);
+  RUN_TEST(test_it_should_wait_for_brace_when_chunk_ends_after_last_value);
+  RUN_TEST(test_it_should_reject_binary_data_after_brace);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
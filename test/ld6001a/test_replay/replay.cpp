@@ -0,0 +1,317 @@
+#define UNITY_INCLUDE_PRINT_FORMATTED 1
+
+#include "unity.h"
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "ld6001a/capture.h"  // Include the header file for the class being tested
+#include "ld6001a/frame_parser.h"
+#include "ld6001a/target_tracker.h"
+#include "ld6001a/zone_engine.h"
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+// Replays a capture through the parser, the target tracker and the zone counting, like the component does.
+//
+// Besides the synthetic capture below, a capture recorded with on_capture can be replayed with
+//
+//   LD6001A_CAPTURE=capture.bin [LD6001A_REPLAY_REALTIME=1] [LD6001A_ZONES="x1,y1,x2,y2;..."] pio test -f ld6001a/test_replay
+//
+// which prints a JSON report to compare between parser or tracker changes.
+static const size_t REPLAY_ZONES = 4;
+
+struct ReplayReport {
+  uint32_t records = 0;
+  uint32_t bytes = 0;
+  uint32_t frames = 0;
+  uint32_t invalid_frames = 0;
+  uint32_t entered = 0;
+  uint32_t left = 0;
+  uint32_t duration_ms = 0;
+  double wall_time_s = 0;
+  bool valid = false;
+  bool truncated = false;
+  std::array<uint32_t, REPLAY_ZONES> zone_target_frames{};  // Sum of the zone target count over all frames
+  std::array<uint8_t, REPLAY_ZONES> zone_peak{};
+};
+
+class ReplayDriver : public FrameHandler, public TargetEventHandler<uint32_t> {
+  public:
+    ZoneEngine zones;
+
+    ReplayDriver() { this->zones.ensure_size(REPLAY_ZONES); }
+
+    ReplayReport run(const std::vector<uint8_t> &capture, bool realtime) {
+      this->report_ = ReplayReport{};
+
+      CaptureReader reader(capture.data(), capture.size());
+      this->report_.valid = reader.valid();
+
+      auto start = std::chrono::steady_clock::now();
+      CaptureRecord record;
+
+      while (reader.next(record)) {
+        if (realtime) {
+          std::this_thread::sleep_until(start + std::chrono::milliseconds(record.time));
+        }
+
+        this->now_ = record.time;
+        this->report_.records++;
+        this->report_.bytes += record.length;
+        this->parser_.push_data(record.data, record.length);
+      }
+
+      std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+      this->report_.wall_time_s = wall_time.count();
+      this->report_.duration_ms = this->now_;
+      this->report_.truncated = reader.truncated();
+      return this->report_;
+    }
+
+    void on_detailed_radar_response(Span<Person> people) override {
+      this->report_.frames++;
+      this->tracker_.update(people, this->now_);
+
+      this->zones.update(people);
+      for (size_t i = 0; i < REPLAY_ZONES; i++) {
+        uint8_t count = this->zones.get_count(i);
+        this->report_.zone_target_frames[i] += count;
+        this->report_.zone_peak[i] = std::max(this->report_.zone_peak[i], count);
+      }
+    }
+
+    void on_invalid_frame() override { this->report_.invalid_frames++; }
+
+    void on_target_enter(uint32_t target_id) override { this->report_.entered++; }
+    void on_target_left(uint32_t target_id, uint32_t dwell_time) override { this->report_.left++; }
+
+  protected:
+    FrameParser parser_{*this};
+    TargetTracker<Person> tracker_{*this};
+    ReplayReport report_;
+    uint32_t now_ = 0;
+};
+
+void print_report(const char *name, const ReplayReport &report) {
+  double frames_per_s = report.wall_time_s > 0 ? report.frames / report.wall_time_s : 0;
+
+  TEST_PRINTF("{\"capture\": \"%s\", \"records\": %u, \"bytes\": %u, \"frames\": %u, \"invalid_frames\": %u, "
+              "\"duration_ms\": %u, \"frames_per_s\": %.0f, \"entered\": %u, \"left\": %u, \"truncated\": %s, "
+              "\"zone_target_frames\": [%u, %u, %u, %u], \"zone_peak\": [%u, %u, %u, %u]}",
+              name, report.records, report.bytes, report.frames, report.invalid_frames, report.duration_ms,
+              frames_per_s, report.entered, report.left, report.truncated ? "true" : "false",
+              report.zone_target_frames[0], report.zone_target_frames[1], report.zone_target_frames[2],
+              report.zone_target_frames[3], report.zone_peak[0], report.zone_peak[1], report.zone_peak[2],
+              report.zone_peak[3]);
+}
+
+std::vector<uint8_t> build_detailed_frame(const std::vector<Person> &people) {
+  std::vector<uint8_t> frame = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+  auto push_uint32 = [&frame](uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+      frame.push_back((value >> (i * 8)) & 0xFF);
+    }
+  };
+  auto push_float = [&push_uint32](float value) {
+    uint32_t u;
+    std::memcpy(&u, &value, sizeof(float));
+    push_uint32(u);
+  };
+
+  push_uint32(32 + people.size() * 32);
+  push_uint32(0x01A3);
+  push_uint32(1);
+  push_uint32(0);
+  push_uint32(2);
+  push_uint32(people.size() * 32);
+
+  for (const auto &person : people) {
+    push_uint32(0);
+    push_uint32(person.id);
+    push_float(person.x);
+    push_float(person.y);
+    push_float(person.z);
+    push_float(person.vx);
+    push_float(person.vy);
+    push_float(person.vz);
+  }
+
+  uint8_t checksum = 0;
+  for (size_t i = 12; i < 16; i++) {
+    checksum ^= frame[i];
+  }
+  for (size_t i = 32; i < frame.size(); i++) {
+    checksum ^= frame[i];
+  }
+  frame.push_back(checksum);
+
+  return frame;
+}
+
+// Ten seconds of radar output: person 1 walks from x = -2m to 2m, person 2 stands at (1m, 1m) from the third to the
+// eighth second. Frames are 100ms apart and read from the UART in chunks that do not line up with them.
+std::vector<uint8_t> record_synthetic_capture() {
+  std::vector<uint8_t> capture;
+  CaptureRecorder<64> recorder([&capture](const uint8_t *data, size_t len) {
+    capture.insert(capture.end(), data, data + len);
+  });
+
+  std::vector<uint8_t> uart;
+  for (uint32_t tick = 0; tick < 100; tick++) {
+    std::vector<Person> people = {{1, -2.0f + tick * 0.04f, 0.0f, 0.0f, 0.4f, 0.0f, 0.0f}};
+    if (tick >= 30 && tick < 80) {
+      people.push_back({2, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f});
+    }
+
+    auto frame = build_detailed_frame(people);
+    uart.insert(uart.end(), frame.begin(), frame.end());
+
+    // Drop some garbage between frames now and then, as the real UART does
+    if (tick % 25 == 0) {
+      uart.push_back(0x5A);
+    }
+
+    size_t chunk = 37 + tick % 50;
+    while (uart.size() >= chunk) {
+      recorder.record(1000 + tick * 100, uart.data(), chunk);
+      uart.erase(uart.begin(), uart.begin() + chunk);
+    }
+  }
+  recorder.record(11000, uart.data(), uart.size());
+  recorder.flush();
+
+  return capture;
+}
+
+void test_capture_should_round_trip_records_and_timestamps(void) {
+  std::vector<uint8_t> capture;
+  CaptureRecorder<32> recorder([&capture](const uint8_t *data, size_t len) {
+    TEST_ASSERT_LESS_OR_EQUAL(32, len);
+    capture.insert(capture.end(), data, data + len);
+  });
+
+  std::vector<uint8_t> large(100);
+  for (size_t i = 0; i < large.size(); i++) {
+    large[i] = i;
+  }
+
+  const uint8_t small[] = {0xAA, 0xBB};
+  recorder.record(5000, small, sizeof(small));
+  recorder.record(5200, large.data(), large.size());
+  recorder.record(70000, small, sizeof(small));
+  recorder.flush();
+
+  CaptureReader reader(capture.data(), capture.size());
+  TEST_ASSERT_TRUE(reader.valid());
+
+  CaptureRecord record;
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> times;
+  while (reader.next(record)) {
+    data.insert(data.end(), record.data, record.data + record.length);
+    times.push_back(record.time);
+  }
+
+  TEST_ASSERT_FALSE(reader.truncated());
+  TEST_ASSERT_EQUAL(104, data.size());
+  TEST_ASSERT_EQUAL(104, recorder.get_bytes_recorded());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(large.data(), data.data() + 2, large.size());
+  TEST_ASSERT_EQUAL(0, times.front());
+  TEST_ASSERT_EQUAL(200, times[1]);
+  TEST_ASSERT_EQUAL(65000, times.back());
+}
+
+void test_capture_should_detect_truncation(void) {
+  auto capture = record_synthetic_capture();
+  capture.resize(capture.size() - 1);  // Cut into the data of the last record
+
+  CaptureReader reader(capture.data(), capture.size());
+  CaptureRecord record;
+  while (reader.next(record)) {
+  }
+
+  TEST_ASSERT_TRUE(reader.truncated());
+
+  const uint8_t not_a_capture[] = {'A', 'T', '+', 'O', 'K', '\r', '\n'};
+  TEST_ASSERT_FALSE(CaptureReader(not_a_capture, sizeof(not_a_capture)).valid());
+}
+
+void test_replay_should_be_deterministic(void) {
+  auto capture = record_synthetic_capture();
+
+  ReplayDriver driver;
+  driver.zones.set_rectangle(0, -300, -300, 0, 300);  // Left half
+  driver.zones.set_rectangle(1, 50, 50, 150, 150);    // Around person 2
+
+  auto report = driver.run(capture, false);
+  print_report("synthetic", report);
+
+  TEST_ASSERT_TRUE(report.valid);
+  TEST_ASSERT_EQUAL(100, report.frames);
+  TEST_ASSERT_EQUAL(0, report.invalid_frames);
+  TEST_ASSERT_FALSE(report.truncated);
+  TEST_ASSERT_EQUAL(2, report.entered);
+  TEST_ASSERT_EQUAL(1, report.left);
+  TEST_ASSERT_EQUAL(51, report.zone_target_frames[0]);
+  TEST_ASSERT_EQUAL(1, report.zone_peak[0]);
+  TEST_ASSERT_EQUAL(50, report.zone_target_frames[1]);
+  TEST_ASSERT_EQUAL(1, report.zone_peak[1]);
+
+  // Replaying the same capture again gives the same result
+  auto again = driver.run(capture, false);
+  TEST_ASSERT_EQUAL(report.frames, again.frames);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(report.zone_target_frames.data(), again.zone_target_frames.data(), REPLAY_ZONES);
+}
+
+void test_replay_capture_from_environment(void) {
+  const char *path = std::getenv("LD6001A_CAPTURE");
+  if (path == nullptr) {
+    TEST_IGNORE_MESSAGE("Set LD6001A_CAPTURE to replay a recorded capture");
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  TEST_ASSERT_TRUE_MESSAGE(file.good(), "Cannot open LD6001A_CAPTURE");
+  std::vector<uint8_t> capture((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  ReplayDriver driver;
+  if (const char *zones = std::getenv("LD6001A_ZONES")) {
+    for (size_t i = 0; i < REPLAY_ZONES && *zones; i++) {
+      ZoneCoordinates zone;
+      int consumed = 0;
+      if (std::sscanf(zones, "%hd,%hd,%hd,%hd%n", &zone.x1, &zone.y1, &zone.x2, &zone.y2, &consumed) != 4) {
+        TEST_FAIL_MESSAGE("LD6001A_ZONES should look like x1,y1,x2,y2;x1,y1,x2,y2");
+      }
+      driver.zones.set_rectangle(i, zone.x1, zone.y1, zone.x2, zone.y2);
+      zones += consumed;
+      zones += *zones == ';';
+    }
+  }
+
+  const char *realtime = std::getenv("LD6001A_REPLAY_REALTIME");
+  auto report = driver.run(capture, realtime != nullptr && realtime[0] == '1');
+  TEST_ASSERT_TRUE_MESSAGE(report.valid, "LD6001A_CAPTURE is not a capture");
+  print_report(path, report);
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_capture_should_round_trip_records_and_timestamps);
+  RUN_TEST(test_capture_should_detect_truncation);
+  RUN_TEST(test_replay_should_be_deterministic);
+  RUN_TEST(test_replay_capture_from_environment);
+  return UNITY_END();
+}
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { 
+  return runUnityTests(); 
+}
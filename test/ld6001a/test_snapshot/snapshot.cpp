@@ -0,0 +1,116 @@
+#include "unity.h"
+#include "ld6001a/snapshot.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+void test_it_should_encode_empty_snapshot(void) {
+  SnapshotEncoder encoder;
+  auto data = encoder.encode(0x12345678, Span<Person>());
+
+  const uint8_t expected[] = {'L', 'D', 'S', SNAPSHOT_VERSION, 0x00, 0x00, 0x78, 0x56, 0x34, 0x12, 0x00};
+  TEST_ASSERT_EQUAL(sizeof(expected), data.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data.begin(), sizeof(expected));
+}
+
+void test_it_should_encode_targets_little_endian(void) {
+  SnapshotEncoder encoder;
+  Person people[] = {{.id = 0x0102, .x = 1.5f, .y = -0.25f, .z = 2.0f, .vx = 0.1f, .vy = -0.1f, .vz = 0}};
+  auto data = encoder.encode(1000, Span<Person>(people, 1));
+
+  const uint8_t expected[] = {0x02, 0x01, 0x00, 0x00,  // id
+                              0xDC, 0x05,              // x = 1500mm
+                              0x06, 0xFF,              // y = -250mm
+                              0xD0, 0x07,              // z = 2000mm
+                              0x64, 0x00,              // vx = 100mm/s
+                              0x9C, 0xFF,              // vy = -100mm/s
+                              0x00, 0x00};             // vz
+  TEST_ASSERT_EQUAL(SNAPSHOT_HEADER_SIZE + SNAPSHOT_TARGET_SIZE, data.size());
+  TEST_ASSERT_EQUAL(1, data[SNAPSHOT_HEADER_SIZE - 1]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data.begin() + SNAPSHOT_HEADER_SIZE, sizeof(expected));
+}
+
+void test_it_should_increment_sequence(void) {
+  SnapshotEncoder encoder;
+  Snapshot snapshot;
+
+  for (uint16_t sequence = 0; sequence < 3; sequence++) {
+    auto data = encoder.encode(0, Span<Person>());
+    TEST_ASSERT_TRUE(decode_snapshot(data.begin(), data.size(), snapshot));
+    TEST_ASSERT_EQUAL(sequence, snapshot.sequence);
+  }
+}
+
+void test_it_should_round_trip_full_snapshot(void) {
+  SnapshotEncoder encoder;
+  std::array<Person, MAX_TARGETS> people;
+  for (size_t i = 0; i < MAX_TARGETS; i++) {
+    people[i] = Person{.id = uint32_t(i + 1), .x = i * 0.1f, .y = -1.0f * i, .z = 2.7f, .vx = 0.05f, .vy = 0, .vz = 0};
+  }
+
+  auto data = encoder.encode(42, Span<Person>(people.data(), people.size()));
+  TEST_ASSERT_EQUAL(SNAPSHOT_MAX_SIZE, data.size());
+
+  Snapshot snapshot;
+  TEST_ASSERT_TRUE(decode_snapshot(data.begin(), data.size(), snapshot));
+  TEST_ASSERT_EQUAL(42, snapshot.timestamp);
+  TEST_ASSERT_EQUAL(MAX_TARGETS, snapshot.count);
+  for (size_t i = 0; i < MAX_TARGETS; i++) {
+    TEST_ASSERT_EQUAL(people[i].id, snapshot.targets[i].id);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, people[i].x, snapshot.targets[i].x);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, people[i].y, snapshot.targets[i].y);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, people[i].z, snapshot.targets[i].z);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, people[i].vx, snapshot.targets[i].vx);
+  }
+}
+
+void test_it_should_clamp_out_of_range_coordinates(void) {
+  SnapshotEncoder encoder;
+  Person people[] = {{.id = 1, .x = 100, .y = -100, .z = NAN, .vx = 0, .vy = 0, .vz = 0}};
+  auto data = encoder.encode(0, Span<Person>(people, 1));
+
+  Snapshot snapshot;
+  TEST_ASSERT_TRUE(decode_snapshot(data.begin(), data.size(), snapshot));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 32.767, snapshot.targets[0].x);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, -32.768, snapshot.targets[0].y);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0, snapshot.targets[0].z);
+}
+
+void test_it_should_reject_invalid_snapshots(void) {
+  SnapshotEncoder encoder;
+  Person people[] = {{.id = 1, .x = 1, .y = 1, .z = 1, .vx = 0, .vy = 0, .vz = 0}};
+  auto data = encoder.encode(0, Span<Person>(people, 1));
+  std::vector<uint8_t> buffer(data.begin(), data.end());
+  Snapshot snapshot;
+
+  TEST_ASSERT_FALSE(decode_snapshot(buffer.data(), buffer.size() - 1, snapshot));
+  TEST_ASSERT_FALSE(decode_snapshot(buffer.data(), SNAPSHOT_HEADER_SIZE - 1, snapshot));
+
+  buffer[3] = SNAPSHOT_VERSION + 1;
+  TEST_ASSERT_FALSE(decode_snapshot(buffer.data(), buffer.size(), snapshot));
+
+  buffer[3] = SNAPSHOT_VERSION;
+  buffer[0] = 'X';
+  TEST_ASSERT_FALSE(decode_snapshot(buffer.data(), buffer.size(), snapshot));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_encode_empty_snapshot);
+  RUN_TEST(test_it_should_encode_targets_little_endian);
+  RUN_TEST(test_it_should_increment_sequence);
+  RUN_TEST(test_it_should_round_trip_full_snapshot);
+  RUN_TEST(test_it_should_clamp_out_of_range_coordinates);
+  RUN_TEST(test_it_should_reject_invalid_snapshots);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
@@ -0,0 +1,200 @@
+#define UNITY_INCLUDE_PRINT_FORMATTED 1
+
+#include "unity.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "ld6001a/target_tracker.h"  // Include the header file for the class being tested
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+struct FakeTarget {
+  uint32_t id;
+};
+
+struct MovingTarget {
+  uint32_t id;
+  float x, y, z;
+  float vx, vy, vz;
+};
+
+class RecordingEventHandler : public TargetEventHandler<uint32_t> {
+  public:
+    std::vector<uint32_t> entered;
+    std::vector<std::pair<uint32_t, uint32_t>> left;
+
+    void on_target_enter(uint32_t target_id) override {
+      entered.push_back(target_id);
+    }
+
+    void on_target_left(uint32_t target_id, uint32_t dwell_time) override {
+      left.push_back({target_id, dwell_time});
+    }
+};
+
+void test_it_should_report_entering_targets_once(void) {
+  RecordingEventHandler handler;
+  TargetTracker<FakeTarget> tracker(handler);
+
+  tracker.update(std::vector<FakeTarget>{{1}, {2}}, 1000);
+  tracker.update(std::vector<FakeTarget>{{2}, {1}}, 1100);
+
+  TEST_ASSERT_EQUAL(2, handler.entered.size());
+  TEST_ASSERT_EQUAL(1, handler.entered[0]);
+  TEST_ASSERT_EQUAL(2, handler.entered[1]);
+  TEST_ASSERT_EQUAL(0, handler.left.size());
+  TEST_ASSERT_EQUAL(2, tracker.size());
+}
+
+void test_it_should_report_leaving_targets_with_dwell_time(void) {
+  RecordingEventHandler handler;
+  TargetTracker<FakeTarget> tracker(handler);
+
+  tracker.update(std::vector<FakeTarget>{{1}, {2}}, 1000);
+  tracker.update(std::vector<FakeTarget>{{2}}, 6500);
+
+  TEST_ASSERT_EQUAL(1, handler.left.size());
+  TEST_ASSERT_EQUAL(1, handler.left[0].first);
+  TEST_ASSERT_EQUAL(5, handler.left[0].second);
+  TEST_ASSERT_FALSE(tracker.contains(1));
+  TEST_ASSERT_TRUE(tracker.contains(2));
+}
+
+void test_it_should_reuse_slots_when_all_targets_are_replaced(void) {
+  RecordingEventHandler handler;
+  TargetTracker<FakeTarget, 4> tracker(handler);
+
+  tracker.update(std::vector<FakeTarget>{{1}, {2}, {3}, {4}}, 0);
+  tracker.update(std::vector<FakeTarget>{{5}, {6}, {7}, {8}}, 100);
+
+  TEST_ASSERT_EQUAL(8, handler.entered.size());
+  TEST_ASSERT_EQUAL(4, handler.left.size());
+  TEST_ASSERT_EQUAL(4, tracker.size());
+  TEST_ASSERT_TRUE(tracker.contains(8));
+}
+
+void test_it_should_ignore_targets_beyond_capacity(void) {
+  RecordingEventHandler handler;
+  TargetTracker<FakeTarget, 2> tracker(handler);
+
+  tracker.update(std::vector<FakeTarget>{{1}, {2}, {3}}, 0);
+
+  TEST_ASSERT_EQUAL(2, handler.entered.size());
+  TEST_ASSERT_FALSE(tracker.contains(3));
+}
+
+void test_it_should_find_colliding_ids(void) {
+  RecordingEventHandler handler;
+  TargetTracker<FakeTarget> tracker(handler);
+  std::vector<FakeTarget> targets;
+
+  // Large and sparse ids end up in the same index buckets
+  for (uint32_t i = 0; i < 16; i++) {
+    targets.push_back({i * 32});
+  }
+
+  tracker.update(targets, 0);
+  tracker.update(targets, 100);
+  targets.erase(targets.begin() + 3);
+  tracker.update(targets, 200);
+
+  TEST_ASSERT_EQUAL(16, handler.entered.size());
+  TEST_ASSERT_EQUAL(1, handler.left.size());
+  TEST_ASSERT_EQUAL(96, handler.left[0].first);
+  TEST_ASSERT_TRUE(tracker.contains(15 * 32));
+}
+
+void test_it_should_not_smooth_by_default(void) {
+  RecordingEventHandler handler;
+  TargetTracker<MovingTarget> tracker(handler);
+  std::vector<MovingTarget> targets{{1, 1.0f, 2.0f, 0, 0, 0, 0}};
+
+  tracker.update(targets, 0);
+  tracker.smooth(targets.begin(), targets.end(), 0);
+  targets[0].x = 3.0f;
+  tracker.update(targets, 100);
+  tracker.smooth(targets.begin(), targets.end(), 100);
+
+  TEST_ASSERT_FALSE(tracker.is_smoothing());
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, targets[0].x);
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, targets[0].y);
+}
+
+void test_it_should_smooth_jitter_of_still_target(void) {
+  RecordingEventHandler handler;
+  TargetTracker<MovingTarget> tracker(handler);
+  tracker.set_smoothing(0.2f, 0.5f);
+
+  float max_deviation = 0;
+  for (uint32_t frame = 0; frame < 50; frame++) {
+    // Alternates 10cm around 1m, like a quantised position right at a step
+    std::vector<MovingTarget> targets{{1, frame % 2 ? 1.05f : 0.95f, 0, 0, 0, 0, 0}};
+    tracker.update(targets, frame * 100);
+    tracker.smooth(targets.begin(), targets.end(), frame * 100);
+
+    if (frame >= 10) {
+      max_deviation = std::max(max_deviation, std::abs(targets[0].x - 1.0f));
+    }
+  }
+
+  TEST_ASSERT_TRUE_MESSAGE(max_deviation < 0.02f, "Smoothed position still jitters");
+}
+
+void test_it_should_follow_moving_target_without_lag(void) {
+  RecordingEventHandler handler;
+  TargetTracker<MovingTarget> tracker(handler);
+  tracker.set_smoothing(0.2f, 0.5f);
+
+  // Walking at 1m/s along x, the prediction from the measured velocity keeps the estimate on track
+  MovingTarget target{};
+  for (uint32_t frame = 0; frame <= 20; frame++) {
+    std::vector<MovingTarget> targets{{1, frame * 0.1f, 0.5f, 0, 1.0f, 0, 0}};
+    tracker.update(targets, frame * 100);
+    tracker.smooth(targets.begin(), targets.end(), frame * 100);
+    target = targets[0];
+  }
+
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 2.0f, target.x);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0.5f, target.y);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 1.0f, target.vx);
+}
+
+void test_it_should_restart_estimate_of_returning_target(void) {
+  RecordingEventHandler handler;
+  TargetTracker<MovingTarget> tracker(handler);
+  tracker.set_smoothing(0.2f, 0.5f);
+
+  std::vector<MovingTarget> targets{{1, 0, 0, 0, 0, 0, 0}};
+  tracker.update(targets, 0);
+  tracker.smooth(targets.begin(), targets.end(), 0);
+  tracker.update(std::vector<MovingTarget>{}, 100);
+
+  // The same id showing up somewhere else is a new target, not a jump to be smoothed
+  targets[0].x = 3.0f;
+  tracker.update(targets, 200);
+  tracker.smooth(targets.begin(), targets.end(), 200);
+
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, targets[0].x);
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_report_entering_targets_once);
+  RUN_TEST(test_it_should_report_leaving_targets_with_dwell_time);
+  RUN_TEST(test_it_should_reuse_slots_when_all_targets_are_replaced);
+  RUN_TEST(test_it_should_ignore_targets_beyond_capacity);
+  RUN_TEST(test_it_should_find_colliding_ids);
+  RUN_TEST(test_it_should_not_smooth_by_default);
+  RUN_TEST(test_it_should_smooth_jitter_of_still_target);
+  RUN_TEST(test_it_should_follow_moving_target_without_lag);
+  RUN_TEST(test_it_should_restart_estimate_of_returning_target);
+  return UNITY_END();
+}
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) { 
+  return runUnityTests(); 
+}
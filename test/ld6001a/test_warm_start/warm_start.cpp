@@ -0,0 +1,92 @@
+#include "unity.h"
+#include "ld6001a/warm_start.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+static const uint32_t SAVE_INTERVAL = 60000;
+
+WarmState<4> make_state(uint32_t fingerprint, uint8_t target_count) {
+  WarmState<4> state;
+  state.fingerprint = fingerprint;
+  state.synced = true;
+  state.target_count = target_count;
+  state.zone_counts = {target_count, 0, 0, 0};
+  return state;
+}
+
+void test_it_should_fingerprint_values(void) {
+  uint32_t a = Fingerprint().add(int16_t(100)).add(int16_t(-100)).get();
+  uint32_t b = Fingerprint().add(int16_t(100)).add(int16_t(-100)).get();
+  uint32_t c = Fingerprint().add(int16_t(-100)).add(int16_t(100)).get();
+
+  TEST_ASSERT_EQUAL_UINT32(a, b);
+  TEST_ASSERT_NOT_EQUAL(a, c);
+  TEST_ASSERT_NOT_EQUAL(Fingerprint().get(), a);
+}
+
+void test_it_should_restore_state_of_same_fingerprint(void) {
+  WarmStart<4> warm_start;
+
+  TEST_ASSERT_TRUE(warm_start.restore(make_state(42, 3), 42));
+  TEST_ASSERT_EQUAL(3, warm_start.state.target_count);
+  TEST_ASSERT_EQUAL(3, warm_start.state.zone_counts[0]);
+  TEST_ASSERT_TRUE(warm_start.state.synced);
+}
+
+void test_it_should_start_cold_with_other_fingerprint(void) {
+  WarmStart<4> warm_start;
+
+  TEST_ASSERT_FALSE(warm_start.restore(make_state(42, 3), 43));
+  TEST_ASSERT_EQUAL(43, warm_start.state.fingerprint);
+  TEST_ASSERT_EQUAL(0, warm_start.state.target_count);
+  TEST_ASSERT_EQUAL(0, warm_start.state.zone_counts[0]);
+  TEST_ASSERT_FALSE(warm_start.state.synced);
+}
+
+void test_it_should_save_only_changes(void) {
+  WarmStart<4> warm_start;
+  warm_start.set_interval(SAVE_INTERVAL);
+  warm_start.restore(make_state(42, 3), 42);
+
+  TEST_ASSERT_FALSE(warm_start.should_save(SAVE_INTERVAL));
+
+  warm_start.state.target_count = 2;
+  TEST_ASSERT_TRUE(warm_start.should_save(SAVE_INTERVAL));
+  warm_start.mark_saved(SAVE_INTERVAL);
+  TEST_ASSERT_FALSE(warm_start.should_save(3 * SAVE_INTERVAL));
+}
+
+void test_it_should_limit_save_rate(void) {
+  WarmStart<4> warm_start;
+  warm_start.set_interval(SAVE_INTERVAL);
+  warm_start.restore(make_state(42, 3), 42);
+
+  warm_start.state.target_count = 2;
+  warm_start.mark_saved(1000);
+
+  warm_start.state.zone_counts[1] = 1;
+  TEST_ASSERT_FALSE(warm_start.should_save(1000 + SAVE_INTERVAL - 1));
+  TEST_ASSERT_TRUE(warm_start.should_save(1000 + SAVE_INTERVAL - 1, true));  // Before a reboot
+  TEST_ASSERT_TRUE(warm_start.should_save(1000 + SAVE_INTERVAL));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_fingerprint_values);
+  RUN_TEST(test_it_should_restore_state_of_same_fingerprint);
+  RUN_TEST(test_it_should_start_cold_with_other_fingerprint);
+  RUN_TEST(test_it_should_save_only_changes);
+  RUN_TEST(test_it_should_limit_save_rate);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
@@ -0,0 +1,108 @@
+#include "unity.h"
+#include <vector>
+#include "ld6001a/zone_engine.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+struct FakeTarget {
+  float x;
+  float y;
+};
+
+// L-shaped room, the top right quarter is missing:
+//
+//   (-200, 200) +-----+ (0, 200)
+//               |     |
+//               |     +-----+ (200, 0)
+//               |           |
+//  (-200, -200) +-----------+ (200, -200)
+void set_l_shape(ZoneEngine &engine, size_t zone) {
+  engine.set_polygon(zone, {{-200, -200}, {200, -200}, {200, 0}, {0, 0}, {0, 200}, {-200, 200}});
+}
+
+void test_it_should_contain_points_of_rectangle(void) {
+  ZoneEngine engine;
+  engine.set_rectangle(0, -100, -50, 100, 50);
+
+  TEST_ASSERT_FALSE(engine.is_polygon(0));
+  TEST_ASSERT_TRUE(engine.contains(0, 0, 0));
+  TEST_ASSERT_TRUE(engine.contains(0, 100, 50));
+  TEST_ASSERT_FALSE(engine.contains(0, 101, 0));
+  TEST_ASSERT_FALSE(engine.contains(0, 0, -51));
+}
+
+void test_it_should_contain_points_of_concave_polygon(void) {
+  ZoneEngine engine;
+  set_l_shape(engine, 0);
+
+  TEST_ASSERT_TRUE(engine.is_polygon(0));
+  TEST_ASSERT_EQUAL(6, engine.get_vertex_count(0));
+  TEST_ASSERT_TRUE(engine.contains(0, -100, 100));
+  TEST_ASSERT_TRUE(engine.contains(0, 100, -100));
+  TEST_ASSERT_TRUE(engine.contains(0, -100, -100));
+  TEST_ASSERT_FALSE(engine.contains(0, 100, 100));  // Missing quarter, inside the bounding box
+  TEST_ASSERT_FALSE(engine.contains(0, 300, 0));
+  TEST_ASSERT_FALSE(engine.contains(0, 0, -300));
+}
+
+void test_it_should_keep_bounding_box_of_polygon(void) {
+  ZoneEngine engine;
+  set_l_shape(engine, 0);
+  auto bounds = engine.get_bounds(0);
+
+  TEST_ASSERT_EQUAL(-200, bounds.x1);
+  TEST_ASSERT_EQUAL(-200, bounds.y1);
+  TEST_ASSERT_EQUAL(200, bounds.x2);
+  TEST_ASSERT_EQUAL(200, bounds.y2);
+}
+
+void test_it_should_contain_points_of_slanted_strip(void) {
+  // Doorway as a thin strip at 45 degrees
+  ZoneEngine engine;
+  engine.set_polygon(0, {{0, 0}, {20, 0}, {120, 100}, {100, 100}});
+
+  TEST_ASSERT_TRUE(engine.contains(0, 60, 50));
+  TEST_ASSERT_FALSE(engine.contains(0, 40, 50));
+  TEST_ASSERT_FALSE(engine.contains(0, 80, 50));
+}
+
+void test_it_should_reject_too_many_vertices(void) {
+  ZoneEngine engine;
+  TEST_ASSERT_TRUE(engine.set_polygon(0, {{0, 0}, {1, 1}, {2, 4}, {3, 9}, {4, 16}, {5, 25}, {6, 36}, {7, 49}, {8, 64},
+                                          {9, 81}, {10, 100}, {11, 121}, {12, 144}, {13, 169}, {14, 196}, {15, 225}}));
+
+  TEST_ASSERT_FALSE(engine.set_polygon(0, {{0, 0}, {1, 1}, {2, 4}, {3, 9}, {4, 16}, {5, 25}, {6, 36}, {7, 49}, {8, 64},
+                                           {9, 81}, {10, 100}, {11, 121}, {12, 144}, {13, 169}, {14, 196}, {15, 225},
+                                           {16, 256}}));
+  TEST_ASSERT_EQUAL(MAX_ZONE_VERTICES, engine.get_vertex_count(0));
+}
+
+void test_it_should_count_targets_in_polygon(void) {
+  ZoneEngine engine;
+  set_l_shape(engine, 0);
+  engine.update(std::vector<FakeTarget>{{-1.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, -1.0f}, {3.0f, 0}});
+
+  TEST_ASSERT_EQUAL(2, engine.get_count(0));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_contain_points_of_rectangle);
+  RUN_TEST(test_it_should_contain_points_of_concave_polygon);
+  RUN_TEST(test_it_should_keep_bounding_box_of_polygon);
+  RUN_TEST(test_it_should_contain_points_of_slanted_strip);
+  RUN_TEST(test_it_should_reject_too_many_vertices);
+  RUN_TEST(test_it_should_count_targets_in_polygon);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
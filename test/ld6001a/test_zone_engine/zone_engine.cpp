@@ -0,0 +1,144 @@
+#include "unity.h"
+#include <vector>
+#include "ld6001a/zone_engine.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+struct FakeTarget {
+  float x;
+  float y;
+};
+
+void test_it_should_report_all_zones_on_first_update(void) {
+  ZoneEngine engine;
+  engine.set_rectangle(0, -100, -100, 100, 100);
+  engine.set_rectangle(2, 200, 200, 300, 300);
+
+  TEST_ASSERT_EQUAL(3, engine.size());
+  TEST_ASSERT_EQUAL_UINT64(0b111, engine.update(std::vector<FakeTarget>{}));
+  TEST_ASSERT_EQUAL_UINT64(0, engine.update(std::vector<FakeTarget>{}));
+}
+
+void test_it_should_report_only_changed_zones(void) {
+  ZoneEngine engine;
+  engine.set_rectangle(0, -100, -100, 100, 100);
+  engine.set_rectangle(1, 200, 200, 300, 300);
+  engine.update(std::vector<FakeTarget>{});
+
+  TEST_ASSERT_EQUAL_UINT64(0b10, engine.update(std::vector<FakeTarget>{{2.5f, 2.5f}}));
+  TEST_ASSERT_EQUAL(0, engine.get_count(0));
+  TEST_ASSERT_EQUAL(1, engine.get_count(1));
+
+  TEST_ASSERT_EQUAL_UINT64(0, engine.update(std::vector<FakeTarget>{{2.2f, 2.9f}}));
+  TEST_ASSERT_EQUAL_UINT64(0b11, engine.update(std::vector<FakeTarget>{{0, 0}, {0.5f, -0.5f}}));
+  TEST_ASSERT_EQUAL(2, engine.get_count(0));
+}
+
+void test_it_should_count_overlapping_zones(void) {
+  ZoneEngine engine;
+  engine.set_rectangle(0, -100, -100, 100, 100);
+  engine.set_rectangle(1, 0, 0, 100, 100);
+
+  engine.update(std::vector<FakeTarget>{{0.5f, 0.5f}, {-0.5f, -0.5f}});
+
+  TEST_ASSERT_EQUAL(2, engine.get_count(0));
+  TEST_ASSERT_EQUAL(1, engine.get_count(1));
+}
+
+void test_it_should_report_zones_of_each_target(void) {
+  ZoneEngine engine;
+  engine.set_rectangle(0, -100, -100, 100, 100);
+  engine.set_rectangle(1, 0, 0, 100, 100);
+  ZoneEngine::mask_type target_zones[3];
+
+  engine.update(std::vector<FakeTarget>{{0.5f, 0.5f}, {-0.5f, -0.5f}, {3.0f, 3.0f}}, target_zones);
+
+  TEST_ASSERT_EQUAL_UINT64(0b11, target_zones[0]);
+  TEST_ASSERT_EQUAL_UINT64(0b01, target_zones[1]);
+  TEST_ASSERT_EQUAL_UINT64(0, target_zones[2]);
+}
+
+void test_it_should_count_polygon_zones(void) {
+  ZoneEngine engine;
+  engine.set_rectangle(0, -300, -300, 300, 300);
+  TEST_ASSERT_TRUE(engine.set_polygon(1, {{-200, -200}, {200, -200}, {200, 0}, {0, 0}, {0, 200}, {-200, 200}}));
+  TEST_ASSERT_TRUE(engine.set_polygon(2, {{0, 0}, {20, 0}, {120, 100}, {100, 100}}));
+
+  TEST_ASSERT_TRUE(engine.is_polygon(1));
+  TEST_ASSERT_EQUAL(6, engine.get_vertex_count(1));
+  TEST_ASSERT_EQUAL(4, engine.get_vertex_count(2));
+  TEST_ASSERT_EQUAL(200, engine.get_bounds(1).x2);
+
+  engine.update(std::vector<FakeTarget>{{-1.0f, 1.0f}, {1.0f, 1.0f}, {0.6f, 0.5f}});
+
+  TEST_ASSERT_EQUAL(3, engine.get_count(0));
+  TEST_ASSERT_EQUAL(1, engine.get_count(1));
+  TEST_ASSERT_EQUAL(1, engine.get_count(2));
+}
+
+void test_it_should_replace_polygon(void) {
+  ZoneEngine engine;
+  engine.set_polygon(0, {{0, 0}, {100, 0}, {0, 100}});
+  engine.set_polygon(1, {{200, 200}, {300, 200}, {300, 300}, {200, 300}});
+  engine.set_polygon(0, {{0, 0}, {100, 0}, {100, 100}, {50, 150}, {0, 100}});
+
+  TEST_ASSERT_EQUAL(5, engine.get_vertex_count(0));
+  TEST_ASSERT_EQUAL(4, engine.get_vertex_count(1));
+
+  engine.update(std::vector<FakeTarget>{{0.9f, 0.9f}, {2.5f, 2.5f}});
+  TEST_ASSERT_EQUAL(1, engine.get_count(0));
+  TEST_ASSERT_EQUAL(1, engine.get_count(1));
+}
+
+void test_it_should_reject_invalid_polygons(void) {
+  ZoneEngine engine;
+
+  TEST_ASSERT_FALSE(engine.set_polygon(0, {{0, 0}, {100, 0}}));
+  TEST_ASSERT_FALSE(engine.set_polygon(ZoneEngine::CAPACITY, {{0, 0}, {100, 0}, {0, 100}}));
+  TEST_ASSERT_EQUAL(0, engine.size());
+}
+
+void test_it_should_match_brute_force_on_grid(void) {
+  // 64 desks of 80x60cm in an 8x8 raster, checked against testing every zone for every position
+  ZoneEngine engine;
+  for (size_t i = 0; i < ZoneEngine::CAPACITY; i++) {
+    int16_t x = -400 + (i % 8) * 100;
+    int16_t y = -400 + (i / 8) * 100;
+    engine.set_rectangle(i, x, y, x + 80, y + 60);
+  }
+
+  for (int16_t y = -420; y <= 420; y += 7) {
+    for (int16_t x = -420; x <= 420; x += 7) {
+      engine.update(std::vector<FakeTarget>{{x / 100.0f, y / 100.0f}});
+
+      for (size_t zone = 0; zone < ZoneEngine::CAPACITY; zone++) {
+        TEST_ASSERT_EQUAL(engine.contains(zone, int16_t(x / 100.0f * 100), int16_t(y / 100.0f * 100)),
+                          engine.get_count(zone));
+      }
+    }
+  }
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_report_all_zones_on_first_update);
+  RUN_TEST(test_it_should_report_only_changed_zones);
+  RUN_TEST(test_it_should_count_overlapping_zones);
+  RUN_TEST(test_it_should_report_zones_of_each_target);
+  RUN_TEST(test_it_should_count_polygon_zones);
+  RUN_TEST(test_it_should_replace_polygon);
+  RUN_TEST(test_it_should_reject_invalid_polygons);
+  RUN_TEST(test_it_should_match_brute_force_on_grid);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}
@@ -0,0 +1,151 @@
+#include "unity.h"
+#include <vector>
+#include "ld6001a/zone_occupancy.h"  // Include the header file for the class being tested
+
+#include <ArduinoFake.h>
+
+using namespace esphome::ld6001a;
+
+struct FakeTarget {
+  uint32_t id;
+};
+
+using Mask = ZoneOccupancy<FakeTarget>::mask_type;
+
+struct ZoneEvent {
+  uint8_t zone;
+  uint32_t target_id;
+  uint32_t dwell_time;
+  bool entered;
+};
+
+class FakeZoneEventHandler : public ZoneEventHandler<uint32_t> {
+ public:
+  std::vector<ZoneEvent> events;
+
+  void on_zone_enter(uint8_t zone, uint32_t target_id) override { events.push_back({zone, target_id, 0, true}); }
+  void on_zone_left(uint8_t zone, uint32_t target_id, uint32_t dwell_time) override {
+    events.push_back({zone, target_id, dwell_time, false});
+  }
+};
+
+void test_it_should_report_target_entering_zones(void) {
+  FakeZoneEventHandler handler;
+  ZoneOccupancy<FakeTarget> occupancy(handler);
+  std::vector<FakeTarget> targets{{7}};
+  Mask zones[] = {0b101};
+
+  occupancy.update(targets, zones, 1000);
+
+  TEST_ASSERT_EQUAL(2, handler.events.size());
+  TEST_ASSERT_EQUAL(0, handler.events[0].zone);
+  TEST_ASSERT_EQUAL(2, handler.events[1].zone);
+  TEST_ASSERT_EQUAL(7, handler.events[1].target_id);
+  TEST_ASSERT_TRUE(handler.events[1].entered);
+  TEST_ASSERT_EQUAL(2, occupancy.size());
+
+  occupancy.update(targets, zones, 1100);
+  TEST_ASSERT_EQUAL(2, handler.events.size());
+}
+
+void test_it_should_report_target_leaving_zone_with_dwell_time(void) {
+  FakeZoneEventHandler handler;
+  ZoneOccupancy<FakeTarget> occupancy(handler);
+  std::vector<FakeTarget> targets{{7}};
+  Mask inside[] = {0b11};
+  Mask moved[] = {0b10};
+
+  occupancy.update(targets, inside, 1000);
+  handler.events.clear();
+  occupancy.update(targets, moved, 6500);
+
+  TEST_ASSERT_EQUAL(1, handler.events.size());
+  TEST_ASSERT_FALSE(handler.events[0].entered);
+  TEST_ASSERT_EQUAL(0, handler.events[0].zone);
+  TEST_ASSERT_EQUAL(7, handler.events[0].target_id);
+  TEST_ASSERT_EQUAL(5, handler.events[0].dwell_time);
+}
+
+void test_it_should_report_disappeared_target_leaving(void) {
+  FakeZoneEventHandler handler;
+  ZoneOccupancy<FakeTarget> occupancy(handler);
+  Mask zones[] = {0b1, 0b1};
+
+  occupancy.update(std::vector<FakeTarget>{{1}, {2}}, zones, 0);
+  handler.events.clear();
+  occupancy.update(std::vector<FakeTarget>{{2}}, zones, 3000);
+
+  TEST_ASSERT_EQUAL(1, handler.events.size());
+  TEST_ASSERT_EQUAL(1, handler.events[0].target_id);
+  TEST_ASSERT_EQUAL(3, handler.events[0].dwell_time);
+  TEST_ASSERT_TRUE(occupancy.is_occupied(0));
+}
+
+void test_it_should_follow_target_by_id_when_order_changes(void) {
+  FakeZoneEventHandler handler;
+  ZoneOccupancy<FakeTarget> occupancy(handler);
+  Mask before[] = {0b01, 0b10};
+  Mask after[] = {0b10, 0b01};
+
+  occupancy.update(std::vector<FakeTarget>{{1}, {2}}, before, 0);
+  handler.events.clear();
+  occupancy.update(std::vector<FakeTarget>{{2}, {1}}, after, 100);
+
+  TEST_ASSERT_EQUAL(0, handler.events.size());
+}
+
+void test_it_should_accumulate_zone_dwell_time(void) {
+  FakeZoneEventHandler handler;
+  ZoneOccupancy<FakeTarget> occupancy(handler);
+  std::vector<FakeTarget> targets{{1}, {2}};
+  Mask both[] = {0b1, 0b1};
+  Mask second[] = {0, 0b1};
+  Mask none[] = {0, 0};
+
+  TEST_ASSERT_EQUAL(0, occupancy.get_dwell_time(0, 500));
+
+  occupancy.update(targets, both, 1000);
+  occupancy.update(targets, second, 3000);  // Still occupied by the second target
+  TEST_ASSERT_EQUAL(4000, occupancy.get_dwell_time(0, 5000));
+
+  occupancy.update(targets, none, 6000);
+  TEST_ASSERT_FALSE(occupancy.is_occupied(0));
+  TEST_ASSERT_EQUAL(0, occupancy.get_dwell_time(0, 7000));
+
+  occupancy.update(targets, both, 10000);
+  TEST_ASSERT_EQUAL(1000, occupancy.get_dwell_time(0, 11000));
+  TEST_ASSERT_EQUAL(6000, occupancy.get_total_time(0, 11000));
+}
+
+void test_it_should_ignore_memberships_beyond_capacity(void) {
+  FakeZoneEventHandler handler;
+  ZoneOccupancy<FakeTarget, 2> occupancy(handler);
+  std::vector<FakeTarget> targets{{1}};
+  Mask zones[] = {0b111};
+
+  occupancy.update(targets, zones, 0);
+
+  TEST_ASSERT_EQUAL(2, occupancy.size());
+  TEST_ASSERT_EQUAL(2, handler.events.size());
+  TEST_ASSERT_TRUE(occupancy.is_occupied(2));
+}
+
+int runUnityTests(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_it_should_report_target_entering_zones);
+  RUN_TEST(test_it_should_report_target_leaving_zone_with_dwell_time);
+  RUN_TEST(test_it_should_report_disappeared_target_leaving);
+  RUN_TEST(test_it_should_follow_target_by_id_when_order_changes);
+  RUN_TEST(test_it_should_accumulate_zone_dwell_time);
+  RUN_TEST(test_it_should_ignore_memberships_beyond_capacity);
+  return UNITY_END();
+}
+
+// WARNING!!! PLEASE REMOVE UNNECESSARY MAIN IMPLEMENTATIONS //
+
+/**
+ * For native dev-platform or for some embedded frameworks
+ */
+int main(void) {
+  return runUnityTests();
+}